@@ -0,0 +1,315 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "allocation.hpp"
+#include "compiled.hpp"
+#include "complex_batch.hpp"
+#include "double_double.hpp"
+#include "expression.hpp"
+#include "generator.hpp"
+#include "interval.hpp"
+#include "minimize.hpp"
+#include "mixed_precision.hpp"
+#include "systems.hpp"
+
+namespace {
+constexpr uint32_t seed = 20240601;
+
+std::string workload(size_t size) {
+    symcpp::GeneratorOptions options;
+    options.size = size;
+    options.weights[size_t(symcpp::NodeKind::Ln)] = 0;
+    options.weights[size_t(symcpp::NodeKind::Exp)] = 0;
+    return symcpp::ExpressionGenerator<>(options, seed + size).text();
+}
+
+template <typename F>
+void count_allocations(benchmark::State& state, F&& body) {
+    if (!symcpp::allocation::installed()) {
+        return;
+    }
+    symcpp::allocation::reset();
+    symcpp::allocation::enable();
+    body();
+    symcpp::allocation::enable(false);
+    auto usage = symcpp::allocation::total();
+    state.counters["allocations"] = double(usage.allocations);
+    state.counters["allocated_bytes"] = double(usage.bytes);
+}
+
+template <typename T>
+std::vector<std::vector<T>> columns(size_t count, size_t rows) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.1, 1.0);
+    std::vector<std::vector<T>> result(count, std::vector<T>(rows));
+    for (auto& column : result) {
+        for (auto& value : column) {
+            value = T(uniform(rng));
+        }
+    }
+    return result;
+}
+
+void BM_Parse(benchmark::State& state) {
+    std::string text = workload(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(symcpp::parse_expression<double>(text));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+    count_allocations(state, [&] { symcpp::parse_expression<double>(text); });
+}
+BENCHMARK(BM_Parse)->RangeMultiplier(8)->Range(8, 4096);
+
+void BM_BuildWithFolding(benchmark::State& state) {
+    size_t terms = state.range(0);
+    symcpp::Expression<double> x("x");
+    for (auto _ : state) {
+        symcpp::Expression<double> sum(0.0);
+        for (size_t k = 0; k < terms; ++k) {
+            symcpp::Expression<double> scale =
+                symcpp::Expression<double>(double(k)) * 2.0 + 1.0;
+            sum = sum + scale * x.pow(symcpp::Expression<double>(2.0));
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * terms);
+}
+BENCHMARK(BM_BuildWithFolding)->RangeMultiplier(8)->Range(8, 4096);
+
+void BM_TreeEval(benchmark::State& state) {
+    auto expr = symcpp::parse_expression<double>(workload(state.range(0)));
+    std::map<std::string, double> values{
+        {"a", 0.3}, {"b", 0.5}, {"c", 0.7}, {"d", 0.9}};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(expr.eval(values));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TreeEval)->RangeMultiplier(8)->Range(8, 4096);
+
+template <typename T>
+void BM_CompiledBatch(benchmark::State& state) {
+    constexpr size_t rows = 4096;
+    auto expr = symcpp::parse_expression<T>(workload(state.range(0)));
+    symcpp::CompiledExpression<T> compiled(expr);
+    auto data = columns<T>(compiled.variables().size(), rows);
+    std::vector<const T*> pointers;
+    for (const auto& column : data) {
+        pointers.push_back(column.data());
+    }
+    std::vector<T> out(rows);
+    T* results[] = {out.data()};
+    typename symcpp::CompiledExpression<T>::Workspace workspace;
+    for (auto _ : state) {
+        compiled.eval_batch(pointers.data(), rows, results, workspace);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+    count_allocations(state, [&] {
+        compiled.eval_batch(pointers.data(), rows, results, workspace);
+    });
+}
+BENCHMARK(BM_CompiledBatch<float>)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BM_CompiledBatch<double>)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BM_CompiledBatch<long double>)
+    ->RangeMultiplier(8)
+    ->Range(8, 4096);
+BENCHMARK(BM_CompiledBatch<symcpp::DoubleDouble>)
+    ->RangeMultiplier(8)
+    ->Range(8, 512);
+BENCHMARK(BM_CompiledBatch<symcpp::Interval<double>>)
+    ->RangeMultiplier(8)
+    ->Range(8, 512);
+
+void BM_MixedPrecision(benchmark::State& state) {
+    constexpr size_t rows = 4096;
+    auto expr = symcpp::parse_expression<double>(workload(state.range(0)));
+    symcpp::MixedPrecisionEvaluator evaluator(
+        symcpp::CompiledExpression<double>(expr), 1e-4);
+    auto data = columns<double>(evaluator.variables().size(), rows);
+    std::vector<const double*> pointers;
+    for (const auto& column : data) {
+        pointers.push_back(column.data());
+    }
+    std::vector<double> out(rows);
+    double* results[] = {out.data()};
+    symcpp::MixedPrecisionEvaluator::Workspace workspace;
+    symcpp::MixedPrecisionEvaluator::Statistics statistics;
+    for (auto _ : state) {
+        evaluator.eval_batch(pointers.data(), rows, results, workspace,
+                             &statistics);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+    state.counters["refined"] = benchmark::Counter(
+        double(statistics.refined) / double(statistics.rows));
+}
+BENCHMARK(BM_MixedPrecision)->RangeMultiplier(8)->Range(8, 512);
+
+void BM_ComplexBatch(benchmark::State& state) {
+    constexpr size_t rows = 4096;
+    auto expr = symcpp::parse_expression<symcpp::Complexes_t>(
+        workload(state.range(0)));
+    symcpp::CompiledExpression<symcpp::Complexes_t> compiled(expr);
+    symcpp::ComplexBatchEvaluator evaluator(compiled);
+    auto re = columns<double>(evaluator.variables().size(), rows);
+    auto im = columns<double>(evaluator.variables().size(), rows);
+    std::vector<const double*> re_columns, im_columns;
+    for (size_t v = 0; v < re.size(); ++v) {
+        re_columns.push_back(re[v].data());
+        im_columns.push_back(im[v].data());
+    }
+    std::vector<double> f_re(rows), f_im(rows);
+    double* re_results[] = {f_re.data()};
+    double* im_results[] = {f_im.data()};
+    symcpp::ComplexBatchEvaluator::Workspace workspace;
+    for (auto _ : state) {
+        evaluator.eval_batch(re_columns.data(), im_columns.data(), rows,
+                             re_results, im_results, workspace);
+        benchmark::DoNotOptimize(f_re.data());
+    }
+    state.SetItemsProcessed(state.iterations() * rows);
+}
+BENCHMARK(BM_ComplexBatch)->RangeMultiplier(8)->Range(8, 512);
+
+void BM_Diff(benchmark::State& state) {
+    auto expr = symcpp::parse_expression<double>(workload(64));
+    size_t order = state.range(0);
+    size_t length = 0;
+    for (auto _ : state) {
+        symcpp::Expression<double> derivative = expr;
+        for (size_t k = 0; k < order; ++k) {
+            derivative = derivative.diff("a");
+        }
+        benchmark::DoNotOptimize(derivative);
+        state.PauseTiming();
+        length = derivative.to_string().size();
+        state.ResumeTiming();
+    }
+    state.counters["output_chars"] = double(length);
+    count_allocations(state, [&] {
+        symcpp::Expression<double> derivative = expr;
+        for (size_t k = 0; k < order; ++k) {
+            derivative = derivative.diff("a");
+        }
+    });
+}
+BENCHMARK(BM_Diff)->DenseRange(1, 4);
+
+void BM_ToString(benchmark::State& state) {
+    auto expr = symcpp::parse_expression<double>(workload(state.range(0)));
+    size_t bytes = 0;
+    for (auto _ : state) {
+        std::string text = expr.to_string();
+        bytes += text.size();
+        benchmark::DoNotOptimize(text);
+    }
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_ToString)->RangeMultiplier(8)->Range(8, 4096);
+
+void BM_SparseSystem(benchmark::State& state) {
+    size_t n = state.range(0);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.5, 1.5);
+    std::vector<symcpp::Expression<double>> residuals;
+    std::vector<std::string> unknowns;
+    for (size_t i = 0; i < n; ++i) {
+        unknowns.push_back("u" + std::to_string(i));
+    }
+    for (size_t i = 0; i < n; ++i) {
+        symcpp::Expression<double> u(unknowns[i]);
+        symcpp::Expression<double> r = u * u * u + 3.0 * u - uniform(rng);
+        if (i > 0) {
+            r = r - symcpp::Expression<double>(unknowns[i - 1]);
+        }
+        if (i + 1 < n) {
+            r = r - symcpp::Expression<double>(unknowns[i + 1]);
+        }
+        residuals.push_back(r);
+    }
+    symcpp::SystemSolver<double> solver(residuals, unknowns);
+    std::vector<double> guess(n, 0.0);
+    typename symcpp::SystemSolver<double>::Workspace workspace;
+    size_t iterations = 0;
+    for (auto _ : state) {
+        auto solution = solver.solve(guess, {}, &workspace);
+        iterations = solution.iterations;
+        benchmark::DoNotOptimize(solution.x.data());
+    }
+    state.counters["iterations"] = double(iterations);
+}
+BENCHMARK(BM_SparseSystem)->RangeMultiplier(2)->Range(16, 256);
+
+symcpp::Expression<double> rosenbrock(size_t n,
+                                      std::vector<std::string>& variables) {
+    variables.clear();
+    for (size_t i = 0; i < n; ++i) {
+        variables.push_back("v" + std::to_string(i));
+    }
+    symcpp::Expression<double> sum(0.0);
+    for (size_t i = 0; i + 1 < n; ++i) {
+        symcpp::Expression<double> a(variables[i]);
+        symcpp::Expression<double> b(variables[i + 1]);
+        symcpp::Expression<double> c = b - a * a;
+        symcpp::Expression<double> d = 1.0 - a;
+        sum = sum + 100.0 * c * c + d * d;
+    }
+    return sum;
+}
+
+void BM_MinimizeFused(benchmark::State& state) {
+    std::vector<std::string> variables;
+    auto objective = rosenbrock(state.range(0), variables);
+    symcpp::Minimizer<double> minimizer(objective, variables);
+    std::vector<double> guess(variables.size(), -1.0);
+    typename symcpp::Minimizer<double>::Workspace workspace;
+    for (auto _ : state) {
+        auto result = minimizer.minimize(guess, {}, {}, {}, &workspace);
+        benchmark::DoNotOptimize(result.value);
+    }
+}
+BENCHMARK(BM_MinimizeFused)->RangeMultiplier(4)->Range(4, 64);
+
+void BM_GradientDiffEval(benchmark::State& state) {
+    std::vector<std::string> variables;
+    auto objective = rosenbrock(state.range(0), variables);
+    std::map<std::string, double> point;
+    for (const auto& name : variables) {
+        point[name] = -1.0;
+    }
+    for (auto _ : state) {
+        double value = objective.eval(point);
+        for (const auto& name : variables) {
+            value += objective.diff(name).eval(point);
+        }
+        benchmark::DoNotOptimize(value);
+    }
+}
+BENCHMARK(BM_GradientDiffEval)->RangeMultiplier(4)->Range(4, 64);
+
+void BM_GradientFused(benchmark::State& state) {
+    std::vector<std::string> variables;
+    auto objective = rosenbrock(state.range(0), variables);
+    std::vector<symcpp::Expression<double>> outputs{objective};
+    for (const auto& derivative : objective.gradient(variables)) {
+        outputs.push_back(derivative);
+    }
+    symcpp::CompiledExpression<double> tape(outputs);
+    std::vector<double> inputs(tape.variables().size(), -1.0);
+    std::vector<double> results(outputs.size());
+    typename symcpp::CompiledExpression<double>::Workspace workspace;
+    for (auto _ : state) {
+        tape.eval(inputs.data(), results.data(), workspace);
+        benchmark::DoNotOptimize(results.data());
+    }
+}
+BENCHMARK(BM_GradientFused)->RangeMultiplier(4)->Range(4, 64);
+}  // namespace
+
+BENCHMARK_MAIN();
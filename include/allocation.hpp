@@ -0,0 +1,230 @@
+#ifndef ALLOCATION_HPP
+#define ALLOCATION_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+
+#include "node_kind.hpp"
+
+namespace symcpp {
+namespace allocation {
+enum class Operation : uint8_t {
+    None,
+    Parse,
+    Build,
+    Diff,
+    ToString,
+    Eval,
+    Compile,
+};
+
+inline constexpr size_t operation_count = 7;
+
+inline const char* operation_name(Operation operation) {
+    switch (operation) {
+        case Operation::None:
+            return "other";
+        case Operation::Parse:
+            return "parse";
+        case Operation::Build:
+            return "build";
+        case Operation::Diff:
+            return "diff";
+        case Operation::ToString:
+            return "to_string";
+        case Operation::Eval:
+            return "eval";
+        case Operation::Compile:
+            return "compile";
+    }
+    return "unknown";
+}
+
+struct Usage {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    uint64_t frees = 0;
+    uint64_t freed_bytes = 0;
+};
+
+namespace detail {
+struct Counters {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> frees{0};
+    std::atomic<uint64_t> freed_bytes{0};
+};
+
+inline constexpr uint8_t no_kind = 0xff;
+
+inline std::atomic<bool> enabled_flag{false};
+inline std::atomic<bool> installed_flag{false};
+inline std::array<Counters, operation_count> operations;
+inline std::array<Counters, node_kind_count> kinds;
+inline thread_local Operation current_operation = Operation::None;
+inline thread_local uint8_t current_kind = no_kind;
+
+inline Usage snapshot(const Counters& counters) {
+    return {counters.allocations.load(std::memory_order_relaxed),
+            counters.bytes.load(std::memory_order_relaxed),
+            counters.frees.load(std::memory_order_relaxed),
+            counters.freed_bytes.load(std::memory_order_relaxed)};
+}
+};  // namespace detail
+
+inline bool enabled() {
+    return detail::enabled_flag.load(std::memory_order_relaxed);
+}
+
+inline void enable(bool on = true) {
+    detail::enabled_flag.store(on, std::memory_order_relaxed);
+}
+
+inline bool installed() {
+    return detail::installed_flag.load(std::memory_order_relaxed);
+}
+
+inline void reset() {
+    auto clear = [](detail::Counters& counters) {
+        counters.allocations.store(0, std::memory_order_relaxed);
+        counters.bytes.store(0, std::memory_order_relaxed);
+        counters.frees.store(0, std::memory_order_relaxed);
+        counters.freed_bytes.store(0, std::memory_order_relaxed);
+    };
+    for (auto& counters : detail::operations) {
+        clear(counters);
+    }
+    for (auto& counters : detail::kinds) {
+        clear(counters);
+    }
+}
+
+inline void record_allocation(size_t size) {
+    if (!enabled()) {
+        return;
+    }
+    auto& counters =
+        detail::operations[static_cast<size_t>(detail::current_operation)];
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    counters.bytes.fetch_add(size, std::memory_order_relaxed);
+    if (detail::current_kind != detail::no_kind) {
+        auto& kind = detail::kinds[detail::current_kind];
+        kind.allocations.fetch_add(1, std::memory_order_relaxed);
+        kind.bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+}
+
+inline void record_free(size_t size, uint8_t kind = detail::no_kind) {
+    if (!enabled()) {
+        return;
+    }
+    auto& counters =
+        detail::operations[static_cast<size_t>(detail::current_operation)];
+    counters.frees.fetch_add(1, std::memory_order_relaxed);
+    counters.freed_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (kind != detail::no_kind) {
+        auto& freed = detail::kinds[kind];
+        freed.frees.fetch_add(1, std::memory_order_relaxed);
+        freed.freed_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+}
+
+inline Usage usage(Operation operation) {
+    return detail::snapshot(
+        detail::operations[static_cast<size_t>(operation)]);
+}
+
+inline Usage usage(NodeKind kind) {
+    return detail::snapshot(detail::kinds[static_cast<size_t>(kind)]);
+}
+
+inline Usage total() {
+    Usage result;
+    for (const auto& counters : detail::operations) {
+        Usage part = detail::snapshot(counters);
+        result.allocations += part.allocations;
+        result.bytes += part.bytes;
+        result.frees += part.frees;
+        result.freed_bytes += part.freed_bytes;
+    }
+    return result;
+}
+
+class Scope {
+   public:
+    explicit Scope(Operation operation)
+        : active(enabled() && detail::current_operation == Operation::None) {
+        if (active) {
+            detail::current_operation = operation;
+        }
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    ~Scope() {
+        if (active) {
+            detail::current_operation = Operation::None;
+        }
+    }
+
+   private:
+    bool active;
+};
+
+class KindScope {
+   public:
+    explicit KindScope(NodeKind kind) : active(enabled()) {
+        if (active) {
+            previous = detail::current_kind;
+            detail::current_kind = static_cast<uint8_t>(kind);
+        }
+    }
+
+    KindScope(const KindScope&) = delete;
+    KindScope& operator=(const KindScope&) = delete;
+
+    ~KindScope() {
+        if (active) {
+            detail::current_kind = previous;
+        }
+    }
+
+   private:
+    bool active;
+    uint8_t previous = detail::no_kind;
+};
+
+inline void report(std::ostream& os) {
+    auto row = [&os](const char* name, const Usage& usage) {
+        os << std::left << std::setw(16) << name << std::right
+           << std::setw(14) << usage.allocations << std::setw(14)
+           << usage.bytes << std::setw(14) << usage.frees << std::setw(14)
+           << usage.freed_bytes << '\n';
+    };
+    os << std::left << std::setw(16) << "operation" << std::right
+       << std::setw(14) << "allocations" << std::setw(14) << "bytes"
+       << std::setw(14) << "frees" << std::setw(14) << "freed bytes"
+       << '\n';
+    for (size_t i = 0; i < operation_count; ++i) {
+        auto operation = static_cast<Operation>(i);
+        row(operation_name(operation), usage(operation));
+    }
+    os << '\n'
+       << std::left << std::setw(16) << "node kind" << std::right
+       << std::setw(14) << "allocations" << std::setw(14) << "bytes"
+       << std::setw(14) << "frees" << std::setw(14) << "freed bytes"
+       << '\n';
+    for (size_t i = 0; i < node_kind_count; ++i) {
+        auto kind = static_cast<NodeKind>(i);
+        row(node_kind_name(kind), usage(kind));
+    }
+}
+
+};  // namespace allocation
+};  // namespace symcpp
+
+#endif  // ALLOCATION_HPP
@@ -0,0 +1,226 @@
+#ifndef BANDED_HPP
+#define BANDED_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace symcpp {
+class BandedPattern {
+   public:
+    BandedPattern() = default;
+
+    BandedPattern(size_t size, const std::vector<uint32_t>& row_starts,
+                  const std::vector<uint32_t>& columns)
+        : n(size), position(size) {
+        std::iota(position.begin(), position.end(), uint32_t(0));
+        measure(row_starts, columns);
+        size_t natural_lower = lower_width, natural_upper = upper_width;
+        std::vector<uint32_t> natural = position;
+
+        reorder(row_starts, columns);
+        measure(row_starts, columns);
+        if (lower_width + upper_width >= natural_lower + natural_upper) {
+            position.swap(natural);
+            lower_width = natural_lower;
+            upper_width = natural_upper;
+        }
+    }
+
+    size_t size() const { return n; }
+    size_t lower() const { return lower_width; }
+    size_t upper() const { return upper_width; }
+    const std::vector<uint32_t>& positions() const { return position; }
+
+   private:
+    void measure(const std::vector<uint32_t>& row_starts,
+                 const std::vector<uint32_t>& columns) {
+        lower_width = upper_width = 0;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t k = row_starts[i]; k < row_starts[i + 1]; ++k) {
+                size_t row = position[i], column = position[columns[k]];
+                if (row > column) {
+                    lower_width = std::max(lower_width, row - column);
+                } else {
+                    upper_width = std::max(upper_width, column - row);
+                }
+            }
+        }
+    }
+
+    void reorder(const std::vector<uint32_t>& row_starts,
+                 const std::vector<uint32_t>& columns) {
+        std::vector<std::vector<uint32_t>> neighbours(n);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t k = row_starts[i]; k < row_starts[i + 1]; ++k) {
+                if (columns[k] != i) {
+                    neighbours[i].push_back(columns[k]);
+                    neighbours[columns[k]].push_back(i);
+                }
+            }
+        }
+        for (auto& list : neighbours) {
+            std::sort(list.begin(), list.end());
+            list.erase(std::unique(list.begin(), list.end()), list.end());
+        }
+        auto by_degree = [&neighbours](uint32_t a, uint32_t b) {
+            return neighbours[a].size() < neighbours[b].size();
+        };
+
+        std::vector<uint32_t> starts(n), sequence;
+        std::iota(starts.begin(), starts.end(), uint32_t(0));
+        std::stable_sort(starts.begin(), starts.end(), by_degree);
+        std::vector<bool> visited(n);
+        sequence.reserve(n);
+        for (uint32_t start : starts) {
+            if (visited[start]) {
+                continue;
+            }
+            visited[start] = true;
+            sequence.push_back(start);
+            for (size_t head = sequence.size() - 1; head < sequence.size();
+                 ++head) {
+                size_t first = sequence.size();
+                for (uint32_t next : neighbours[sequence[head]]) {
+                    if (!visited[next]) {
+                        visited[next] = true;
+                        sequence.push_back(next);
+                    }
+                }
+                std::stable_sort(sequence.begin() + first, sequence.end(),
+                                 by_degree);
+            }
+        }
+        for (size_t k = 0; k < n; ++k) {
+            position[sequence[k]] = static_cast<uint32_t>(n - 1 - k);
+        }
+    }
+
+    size_t n = 0;
+    size_t lower_width = 0, upper_width = 0;
+    std::vector<uint32_t> position;
+};
+
+template <typename T>
+class BandedLuFactorization {
+   public:
+    size_t size() const { return n; }
+
+    bool factor(const BandedPattern& pattern, const uint32_t* row_starts,
+                const uint32_t* columns, const T* values) {
+        using std::fabs;
+        n = pattern.size();
+        lower = pattern.lower();
+        upper = pattern.lower() + pattern.upper();
+        width = lower + upper + 1;
+        position = pattern.positions();
+        band.assign(n * width, T(0));
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t k = row_starts[i]; k < row_starts[i + 1]; ++k) {
+                band[index(position[i], position[columns[k]])] = values[k];
+            }
+        }
+
+        pivots.resize(n);
+        for (size_t k = 0; k < n; ++k) {
+            size_t last = std::min(n - 1, k + lower);
+            size_t end = std::min(n - 1, k + upper);
+            size_t pivot = k;
+            for (size_t i = k + 1; i <= last; ++i) {
+                if (fabs(band[index(i, k)]) > fabs(band[index(pivot, k)])) {
+                    pivot = i;
+                }
+            }
+            pivots[k] = static_cast<uint32_t>(pivot);
+            if (!(fabs(band[index(pivot, k)]) > 0)) {
+                return false;
+            }
+            if (pivot != k) {
+                for (size_t j = k; j <= end; ++j) {
+                    std::swap(band[index(k, j)], band[index(pivot, j)]);
+                }
+            }
+            T inverse = T(1) / band[index(k, k)];
+            const T* top = band.data() + index(k, k);
+            for (size_t i = k + 1; i <= last; ++i) {
+                T factor = band[index(i, k)] *= inverse;
+                if (factor == 0) {
+                    continue;
+                }
+                T* row = band.data() + index(i, k);
+                for (size_t j = 1; j <= end - k; ++j) {
+                    row[j] -= factor * top[j];
+                }
+            }
+        }
+        return true;
+    }
+
+    void solve(T* x) {
+        permute(x);
+        for (size_t k = 0; k < n; ++k) {
+            std::swap(scratch[k], scratch[pivots[k]]);
+            T value = scratch[k];
+            for (size_t i = k + 1; i <= std::min(n - 1, k + lower); ++i) {
+                scratch[i] -= band[index(i, k)] * value;
+            }
+        }
+        for (size_t i = n; i-- > 0;) {
+            T sum = scratch[i];
+            for (size_t j = i + 1; j <= std::min(n - 1, i + upper); ++j) {
+                sum -= band[index(i, j)] * scratch[j];
+            }
+            scratch[i] = sum / band[index(i, i)];
+        }
+        restore(x);
+    }
+
+    void solve_transposed(T* x) {
+        permute(x);
+        for (size_t i = 0; i < n; ++i) {
+            T value = scratch[i] /= band[index(i, i)];
+            for (size_t j = i + 1; j <= std::min(n - 1, i + upper); ++j) {
+                scratch[j] -= band[index(i, j)] * value;
+            }
+        }
+        for (size_t k = n; k-- > 0;) {
+            T sum = scratch[k];
+            for (size_t i = k + 1; i <= std::min(n - 1, k + lower); ++i) {
+                sum -= band[index(i, k)] * scratch[i];
+            }
+            scratch[k] = sum;
+            std::swap(scratch[k], scratch[pivots[k]]);
+        }
+        restore(x);
+    }
+
+   private:
+    size_t index(size_t row, size_t column) const {
+        return row * width + lower + column - row;
+    }
+
+    void permute(const T* x) {
+        scratch.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            scratch[position[i]] = x[i];
+        }
+    }
+
+    void restore(T* x) const {
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = scratch[position[i]];
+        }
+    }
+
+    size_t n = 0;
+    size_t lower = 0, upper = 0, width = 1;
+    std::vector<T> band, scratch;
+    std::vector<uint32_t> position, pivots;
+};
+
+};  // namespace symcpp
+
+#endif  // BANDED_HPP
@@ -0,0 +1,132 @@
+#ifndef BINARY_IO_HPP
+#define BINARY_IO_HPP
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <bit>
+#include <cerrno>
+#include <complex>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace symcpp {
+static_assert(std::endian::native == std::endian::little,
+              "raw binary columns are read and written as little-endian");
+static_assert(std::numeric_limits<double>::is_iec559,
+              "raw binary columns require IEEE 754 float64");
+
+using Float64_t = double;
+using Complex128_t = std::complex<double>;
+
+template <typename T>
+class MappedArray {
+   public:
+    MappedArray() = default;
+
+    explicit MappedArray(const std::string& path) : path(path) {
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            fail("Cannot open");
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            fail("Cannot stat");
+        }
+        if (st.st_size % sizeof(T) != 0) {
+            fail("Size is not a multiple of " + std::to_string(sizeof(T)) +
+                     " bytes in",
+                 false);
+        }
+        count = st.st_size / sizeof(T);
+        map(PROT_READ, MAP_PRIVATE);
+        if (ptr) {
+            ::madvise(ptr, bytes(), MADV_SEQUENTIAL);
+        }
+    }
+
+    MappedArray(const std::string& path, size_t size)
+        : path(path), count(size) {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            fail("Cannot create");
+        }
+        if (::ftruncate(fd, bytes()) != 0) {
+            fail("Cannot resize");
+        }
+        map(PROT_READ | PROT_WRITE, MAP_SHARED);
+    }
+
+    MappedArray(const MappedArray&) = delete;
+    MappedArray& operator=(const MappedArray&) = delete;
+
+    MappedArray(MappedArray&& other) noexcept { swap(other); }
+    MappedArray& operator=(MappedArray&& other) noexcept {
+        if (this != &other) {
+            MappedArray(std::move(other)).swap(*this);
+        }
+        return *this;
+    }
+
+    ~MappedArray() {
+        if (ptr) {
+            ::munmap(ptr, bytes());
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    T* data() { return static_cast<T*>(ptr); }
+    const T* data() const { return static_cast<const T*>(ptr); }
+    size_t size() const { return count; }
+
+    T& operator[](size_t i) { return data()[i]; }
+    const T& operator[](size_t i) const { return data()[i]; }
+
+   private:
+    void map(int prot, int flags) {
+        if (count == 0) {
+            return;
+        }
+        ptr = ::mmap(nullptr, bytes(), prot, flags, fd, 0);
+        if (ptr == MAP_FAILED) {
+            ptr = nullptr;
+            fail("Cannot map");
+        }
+    }
+
+    [[noreturn]] void fail(const std::string& what, bool system = true) {
+        std::string message = what + " " + path;
+        if (system) {
+            message += ": " + std::string(std::strerror(errno));
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+        throw std::runtime_error(message);
+    }
+
+    void swap(MappedArray& other) noexcept {
+        std::swap(path, other.path);
+        std::swap(fd, other.fd);
+        std::swap(ptr, other.ptr);
+        std::swap(count, other.count);
+    }
+
+    size_t bytes() const { return count * sizeof(T); }
+
+    std::string path;
+    int fd = -1;
+    void* ptr = nullptr;
+    size_t count = 0;
+};
+
+};  // namespace symcpp
+
+#endif  // BINARY_IO_HPP
@@ -0,0 +1,206 @@
+#ifndef CHEBYSHEV_HPP
+#define CHEBYSHEV_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "compiled.hpp"
+#include "expression.hpp"
+
+namespace symcpp {
+struct ChebyshevOptions {
+    size_t max_degree = 64;
+    size_t max_pieces = 256;
+    size_t checks = 4;
+};
+
+template <typename _Domain = double>
+    requires std::is_floating_point_v<_Domain>
+class Chebyshev {
+   public:
+    Chebyshev() = default;
+
+    _Domain operator()(_Domain x) const {
+        size_t piece = std::upper_bound(breaks.begin() + 1, breaks.end() - 1,
+                                        x) -
+                       breaks.begin() - 1;
+        return evaluate(piece, x);
+    }
+
+    void eval_batch(const _Domain* x, size_t n, _Domain* out) const {
+        for (size_t r = 0; r < n; ++r) {
+            out[r] = (*this)(x[r]);
+        }
+    }
+
+    _Domain lower() const { return breaks.front(); }
+    _Domain upper() const { return breaks.back(); }
+    _Domain error() const { return max_error; }
+    size_t pieces() const { return breaks.size() - 1; }
+    size_t degree() const {
+        size_t result = 0;
+        for (size_t p = 0; p + 1 < offsets.size(); ++p) {
+            result = std::max(result, offsets[p + 1] - offsets[p] - 1);
+        }
+        return result;
+    }
+
+   private:
+    template <typename T>
+    friend Chebyshev<T> approximate(const Expression<T>&, const std::string&,
+                                    T, T, T, const std::map<std::string, T>&,
+                                    ChebyshevOptions);
+
+    _Domain evaluate(size_t piece, _Domain x) const {
+        _Domain a = breaks[piece];
+        _Domain b = breaks[piece + 1];
+        _Domain t = (2 * x - a - b) / (b - a);
+        const _Domain* c = coefficients.data() + offsets[piece];
+        size_t n = offsets[piece + 1] - offsets[piece];
+        _Domain b1 = 0;
+        _Domain b2 = 0;
+        for (size_t k = n; k-- > 1;) {
+            _Domain next = c[k] + 2 * t * b1 - b2;
+            b2 = b1;
+            b1 = next;
+        }
+        return c[0] + t * b1 - b2;
+    }
+
+    std::vector<_Domain> breaks;
+    std::vector<size_t> offsets{0};
+    std::vector<_Domain> coefficients;
+    _Domain max_error = 0;
+};
+
+template <typename _Domain>
+Chebyshev<_Domain> approximate(
+    const Expression<_Domain>& expr, const std::string& variable,
+    _Domain lower, _Domain upper, _Domain tolerance,
+    const std::map<std::string, _Domain>& values = {},
+    ChebyshevOptions options = {}) {
+    using std::fabs;
+    if (!(lower < upper)) {
+        throw std::runtime_error("Approximation interval is empty");
+    }
+    CompiledExpression<_Domain> kernel(expr);
+    std::vector<std::vector<_Domain>> columns;
+    for (const auto& name : kernel.variables()) {
+        if (name == variable) {
+            columns.emplace_back();
+            continue;
+        }
+        auto it = values.find(name);
+        if (it == values.end()) {
+            throw std::runtime_error("Variable not found: " + name);
+        }
+        columns.emplace_back(1, it->second);
+    }
+    std::vector<const _Domain*> pointers(columns.size());
+    typename CompiledExpression<_Domain>::Workspace workspace;
+    auto sample = [&](const std::vector<_Domain>& xs,
+                      std::vector<_Domain>& out) {
+        for (size_t v = 0; v < columns.size(); ++v) {
+            if (kernel.variables()[v] == variable) {
+                columns[v] = xs;
+            } else {
+                columns[v].resize(xs.size(), columns[v][0]);
+            }
+            pointers[v] = columns[v].data();
+        }
+        out.resize(xs.size());
+        _Domain* results[] = {out.data()};
+        kernel.eval_batch(pointers.data(), xs.size(), results, workspace);
+        for (_Domain value : out) {
+            if (!std::isfinite(value)) {
+                throw std::runtime_error(
+                    "Expression is not finite on the interval");
+            }
+        }
+    };
+
+    Chebyshev<_Domain> result;
+    result.breaks.push_back(lower);
+    std::vector<std::pair<_Domain, _Domain>> pending{{lower, upper}};
+    std::vector<_Domain> xs, fs, coefficients;
+    const _Domain pi = std::numbers::pi_v<_Domain>;
+    while (!pending.empty()) {
+        auto [a, b] = pending.back();
+        pending.pop_back();
+        bool accepted = false;
+        for (size_t n = 8; n <= options.max_degree; n *= 2) {
+            xs.resize(n + 1);
+            for (size_t j = 0; j <= n; ++j) {
+                _Domain t = std::cos(pi * _Domain(j) / _Domain(n));
+                xs[j] = (a + b) / 2 + (b - a) / 2 * t;
+            }
+            sample(xs, fs);
+            coefficients.assign(n + 1, 0);
+            for (size_t k = 0; k <= n; ++k) {
+                _Domain sum = 0;
+                for (size_t j = 0; j <= n; ++j) {
+                    _Domain weight = j == 0 || j == n ? _Domain(0.5) : 1;
+                    sum += weight * fs[j] *
+                           std::cos(pi * _Domain(j * k % (2 * n)) /
+                                    _Domain(n));
+                }
+                _Domain scale = k == 0 || k == n ? _Domain(1) : _Domain(2);
+                coefficients[k] = scale * sum / _Domain(n);
+            }
+            _Domain tail = 0;
+            size_t kept = n + 1;
+            while (kept > 1 &&
+                   tail + fabs(coefficients[kept - 1]) <= tolerance / 4) {
+                tail += fabs(coefficients[--kept]);
+            }
+            coefficients.resize(kept);
+
+            size_t checks = options.checks * (n + 1);
+            xs.resize(checks);
+            for (size_t j = 0; j < checks; ++j) {
+                xs[j] = a + (b - a) * (_Domain(j) + _Domain(0.5)) /
+                                _Domain(checks);
+            }
+            sample(xs, fs);
+            size_t piece = result.breaks.size() - 1;
+            result.breaks.push_back(b);
+            result.coefficients.insert(result.coefficients.end(),
+                                       coefficients.begin(),
+                                       coefficients.end());
+            result.offsets.push_back(result.coefficients.size());
+            _Domain error = 0;
+            for (size_t j = 0; j < checks; ++j) {
+                error = std::max(error, fabs(result.evaluate(piece, xs[j]) -
+                                             fs[j]));
+            }
+            if (error <= tolerance) {
+                result.max_error = std::max(result.max_error, error);
+                accepted = true;
+                break;
+            }
+            result.breaks.pop_back();
+            result.offsets.pop_back();
+            result.coefficients.resize(result.offsets.back());
+        }
+        if (!accepted) {
+            if (result.pieces() + pending.size() + 2 > options.max_pieces) {
+                throw std::runtime_error(
+                    "Chebyshev approximation did not reach the tolerance");
+            }
+            _Domain middle = a / 2 + b / 2;
+            pending.push_back({middle, b});
+            pending.push_back({a, middle});
+        }
+    }
+    return result;
+}
+
+};  // namespace symcpp
+
+#endif  // CHEBYSHEV_HPP
@@ -0,0 +1,584 @@
+#ifndef COMPILED_HPP
+#define COMPILED_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "allocation.hpp"
+#include "expression.hpp"
+#include "profile.hpp"
+
+namespace symcpp {
+template <typename T>
+struct DomainName {
+    static constexpr const char* value = nullptr;
+};
+
+template <>
+struct DomainName<float> {
+    static constexpr const char* value = "float";
+};
+
+template <>
+struct DomainName<double> {
+    static constexpr const char* value = "double";
+};
+
+template <>
+struct DomainName<long double> {
+    static constexpr const char* value = "long double";
+};
+
+template <>
+struct DomainName<Complexes_t> {
+    static constexpr const char* value = "complex long double";
+};
+
+template <>
+struct DomainName<DoubleDouble> {
+    static constexpr const char* value = "double-double";
+};
+
+template <>
+struct DomainName<Interval<float>> {
+    static constexpr const char* value = "interval float";
+};
+
+template <>
+struct DomainName<Interval<double>> {
+    static constexpr const char* value = "interval double";
+};
+
+template <>
+struct DomainName<Interval<long double>> {
+    static constexpr const char* value = "interval long double";
+};
+
+struct Instruction {
+    NodeKind kind;
+    uint32_t lhs;
+    uint32_t rhs;
+};
+
+template <Numeric _Domain = Reals_t>
+class CompiledExpression {
+   public:
+    static constexpr size_t block_size = 256;
+
+    struct Workspace {
+        std::vector<_Domain> values;
+        std::vector<const _Domain*> registers;
+        std::vector<const _Domain*> columns;
+    };
+
+    CompiledExpression() = default;
+    CompiledExpression(const Expression<_Domain>& expr)
+        : CompiledExpression(std::vector<Expression<_Domain>>{expr}) {}
+    CompiledExpression(const std::vector<Expression<_Domain>>& exprs,
+                       std::vector<std::string> labels = {});
+
+    const std::vector<std::string>& variables() const {
+        return variable_names;
+    }
+    const std::vector<_Domain>& constants() const { return constant_pool; }
+    const std::vector<Instruction>& instructions() const { return code; }
+    const std::vector<uint32_t>& outputs() const { return output_registers; }
+    const std::vector<std::string>& labels() const { return output_labels; }
+
+    std::vector<_Domain> bind(
+        const std::map<std::string, _Domain>& variables) const;
+
+    _Domain eval(const std::map<std::string, _Domain>& variables) const {
+        Workspace workspace;
+        std::vector<_Domain> inputs = bind(variables);
+        std::vector<_Domain> results(output_registers.size());
+        eval(inputs.data(), results.data(), workspace);
+        return results.at(0);
+    }
+
+    void eval(const _Domain* inputs, _Domain* results,
+              Workspace& workspace) const;
+    void eval_batch(const _Domain* const* columns, size_t rows,
+                    _Domain* const* results, Workspace& workspace) const;
+    void eval_batch_or_nan(const _Domain* const* columns, size_t rows,
+                           _Domain* const* results,
+                           Workspace& workspace) const
+        requires std::is_floating_point_v<_Domain>;
+
+    std::vector<uint32_t> slots(const std::vector<std::string>& bound,
+                                std::vector<std::string>& parameters) const;
+
+    void save(std::ostream& os) const;
+    static CompiledExpression load(std::istream& is);
+
+   private:
+    struct Key {
+        NodeKind kind;
+        uint32_t lhs;
+        uint32_t rhs;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            uint64_t h = (uint64_t(key.lhs) << 32) | key.rhs;
+            h ^= uint64_t(key.kind) * 0x9e3779b97f4a7c15ULL;
+            h ^= h >> 29;
+            return static_cast<size_t>(h * 0xbf58476d1ce4e5b9ULL);
+        }
+    };
+
+    struct Builder {
+        std::unordered_map<const void*, uint32_t> nodes;
+        std::unordered_map<Key, uint32_t, KeyHash> instructions;
+        std::unordered_multimap<size_t, uint32_t> constants;
+        std::unordered_map<std::string, uint32_t> variables;
+    };
+
+    uint32_t compile(const Expression<_Domain>& expr, Builder& builder);
+    uint32_t emit(NodeKind kind, uint32_t lhs, uint32_t rhs,
+                  Builder& builder);
+    void execute(const _Domain* const* columns, size_t offset, size_t n,
+                 Workspace& workspace) const;
+    void validate() const;
+
+    std::vector<std::string> variable_names;
+    std::vector<_Domain> constant_pool;
+    std::vector<Instruction> code;
+    std::vector<uint32_t> output_registers;
+    std::vector<std::string> output_labels;
+};
+
+template <typename _Domain>
+size_t constant_hash(const _Domain& value) {
+    if constexpr (std::is_arithmetic_v<_Domain>) {
+        return std::hash<_Domain>{}(value);
+    } else if constexpr (std::is_same_v<_Domain, Complexes_t>) {
+        return std::hash<Reals_t>{}(value.real()) * 31 +
+               std::hash<Reals_t>{}(value.imag());
+    } else if constexpr (std::is_same_v<_Domain, DoubleDouble>) {
+        return std::hash<double>{}(value.high()) * 31 +
+               std::hash<double>{}(value.low());
+    } else if constexpr (is_interval_v<_Domain>) {
+        using Real = typename _Domain::value_type;
+        return std::hash<Real>{}(value.lower()) * 31 +
+               std::hash<Real>{}(value.upper());
+    } else {
+        return 0;
+    }
+}
+
+template <Numeric _Domain>
+CompiledExpression<_Domain>::CompiledExpression(
+    const std::vector<Expression<_Domain>>& exprs,
+    std::vector<std::string> labels)
+    : output_labels(std::move(labels)) {
+    allocation::Scope scope(allocation::Operation::Compile);
+    Builder builder;
+    for (const auto& expr : exprs) {
+        output_registers.push_back(compile(expr, builder));
+    }
+    output_labels.resize(output_registers.size());
+}
+
+template <Numeric _Domain>
+uint32_t CompiledExpression<_Domain>::compile(const Expression<_Domain>& expr,
+                                              Builder& builder) {
+    auto known = builder.nodes.find(expr.id());
+    if (known != builder.nodes.end()) {
+        return known->second;
+    }
+
+    uint32_t reg;
+    NodeKind kind = expr.kind();
+    if (kind == NodeKind::Value) {
+        _Domain value = expr.value();
+        size_t hash = constant_hash(value);
+        uint32_t index = constant_pool.size();
+        auto [first, last] = builder.constants.equal_range(hash);
+        for (auto it = first; it != last; ++it) {
+            if (constant_pool[it->second] == value) {
+                index = it->second;
+                break;
+            }
+        }
+        if (index == constant_pool.size()) {
+            constant_pool.push_back(value);
+            builder.constants.emplace(hash, index);
+        }
+        reg = emit(kind, index, 0, builder);
+    } else if (kind == NodeKind::Variable) {
+        auto [it, inserted] = builder.variables.emplace(
+            expr.name(), static_cast<uint32_t>(variable_names.size()));
+        if (inserted) {
+            variable_names.push_back(expr.name());
+        }
+        reg = emit(kind, it->second, 0, builder);
+    } else if (node_kind_arity(kind) == 1) {
+        reg = emit(kind, compile(expr.operand(0), builder), 0, builder);
+    } else {
+        uint32_t lhs = compile(expr.operand(0), builder);
+        uint32_t rhs = compile(expr.operand(1), builder);
+        reg = emit(kind, lhs, rhs, builder);
+    }
+
+    builder.nodes.emplace(expr.id(), reg);
+    return reg;
+}
+
+template <Numeric _Domain>
+uint32_t CompiledExpression<_Domain>::emit(NodeKind kind, uint32_t lhs,
+                                           uint32_t rhs, Builder& builder) {
+    Key key{kind, lhs, rhs};
+    if ((kind == NodeKind::Add || kind == NodeKind::Multiply) && lhs > rhs) {
+        std::swap(key.lhs, key.rhs);
+    }
+    auto [it, inserted] = builder.instructions.emplace(
+        key, static_cast<uint32_t>(code.size()));
+    if (inserted) {
+        code.push_back({kind, lhs, rhs});
+    }
+    return it->second;
+}
+
+template <Numeric _Domain>
+std::vector<_Domain> CompiledExpression<_Domain>::bind(
+    const std::map<std::string, _Domain>& variables) const {
+    std::vector<_Domain> inputs;
+    inputs.reserve(variable_names.size());
+    for (const auto& name : variable_names) {
+        auto it = variables.find(name);
+        if (it != variables.end()) {
+            inputs.push_back(it->second);
+        } else if (name == "i") {
+            inputs.push_back(imaginary_unit<_Domain>());
+        } else {
+            profile::count(profile::Counter::Exceptions);
+            throw std::runtime_error("Variable not found: " + name);
+        }
+    }
+    return inputs;
+}
+
+template <Numeric _Domain>
+void CompiledExpression<_Domain>::eval(const _Domain* inputs,
+                                       _Domain* results,
+                                       Workspace& workspace) const {
+    allocation::Scope scope(allocation::Operation::Eval);
+    workspace.columns.resize(variable_names.size());
+    for (size_t v = 0; v < variable_names.size(); ++v) {
+        workspace.columns[v] = inputs + v;
+    }
+    execute(workspace.columns.data(), 0, 1, workspace);
+    for (size_t k = 0; k < output_registers.size(); ++k) {
+        results[k] = *workspace.registers[output_registers[k]];
+    }
+}
+
+template <Numeric _Domain>
+void CompiledExpression<_Domain>::eval_batch(const _Domain* const* columns,
+                                             size_t rows,
+                                             _Domain* const* results,
+                                             Workspace& workspace) const {
+    allocation::Scope scope(allocation::Operation::Eval);
+    for (size_t offset = 0; offset < rows; offset += block_size) {
+        size_t n = std::min(block_size, rows - offset);
+        execute(columns, offset, n, workspace);
+        for (size_t k = 0; k < output_registers.size(); ++k) {
+            std::copy_n(workspace.registers[output_registers[k]], n,
+                        results[k] + offset);
+        }
+    }
+}
+
+template <Numeric _Domain>
+void CompiledExpression<_Domain>::eval_batch_or_nan(
+    const _Domain* const* columns, size_t rows, _Domain* const* results,
+    Workspace& workspace) const
+    requires std::is_floating_point_v<_Domain> {
+    try {
+        eval_batch(columns, rows, results, workspace);
+        return;
+    } catch (const std::runtime_error&) {
+    }
+    allocation::Scope scope(allocation::Operation::Eval);
+    workspace.columns.resize(variable_names.size());
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t v = 0; v < variable_names.size(); ++v) {
+            workspace.columns[v] = columns[v] + r;
+        }
+        try {
+            execute(workspace.columns.data(), 0, 1, workspace);
+            for (size_t k = 0; k < output_registers.size(); ++k) {
+                results[k][r] = workspace.registers[output_registers[k]][0];
+            }
+        } catch (const std::runtime_error&) {
+            for (size_t k = 0; k < output_registers.size(); ++k) {
+                results[k][r] = std::numeric_limits<_Domain>::quiet_NaN();
+            }
+        }
+    }
+}
+
+template <Numeric _Domain>
+std::vector<uint32_t> CompiledExpression<_Domain>::slots(
+    const std::vector<std::string>& bound,
+    std::vector<std::string>& parameters) const {
+    std::vector<uint32_t> result;
+    for (const auto& name : variable_names) {
+        auto it = std::find(bound.begin(), bound.end(), name);
+        if (it != bound.end()) {
+            result.push_back(it - bound.begin());
+            continue;
+        }
+        auto parameter = std::find(parameters.begin(), parameters.end(), name);
+        if (parameter == parameters.end()) {
+            parameter = parameters.insert(parameters.end(), name);
+        }
+        result.push_back(bound.size() + (parameter - parameters.begin()));
+    }
+    return result;
+}
+
+template <Numeric _Domain>
+void CompiledExpression<_Domain>::execute(const _Domain* const* columns,
+                                          size_t offset, size_t n,
+                                          Workspace& workspace) const {
+    profile::count(profile::Counter::Evaluations, code.size() * n);
+    workspace.values.resize(code.size() * n);
+    workspace.registers.resize(code.size());
+
+    for (size_t i = 0; i < code.size(); ++i) {
+        const Instruction& instruction = code[i];
+        size_t arity = node_kind_arity(instruction.kind);
+        _Domain* out = workspace.values.data() + i * n;
+        const _Domain* a =
+            arity > 0 ? workspace.registers[instruction.lhs] : nullptr;
+        const _Domain* b =
+            arity > 1 ? workspace.registers[instruction.rhs] : nullptr;
+        workspace.registers[i] = out;
+
+        switch (instruction.kind) {
+            case NodeKind::Value:
+                std::fill_n(out, n, constant_pool[instruction.lhs]);
+                break;
+            case NodeKind::Variable:
+                workspace.registers[i] = columns[instruction.lhs] + offset;
+                break;
+            case NodeKind::Add:
+                for (size_t r = 0; r < n; ++r) out[r] = a[r] + b[r];
+                break;
+            case NodeKind::Subtract:
+                for (size_t r = 0; r < n; ++r) out[r] = a[r] - b[r];
+                break;
+            case NodeKind::Multiply:
+                for (size_t r = 0; r < n; ++r) out[r] = a[r] * b[r];
+                break;
+            case NodeKind::Divide: {
+                bool zero = false;
+                for (size_t r = 0; r < n; ++r) zero |= b[r] == _Domain(0.);
+                if (zero) {
+                    profile::count(profile::Counter::Exceptions);
+                    throw std::runtime_error("Division by zero");
+                }
+                for (size_t r = 0; r < n; ++r) out[r] = a[r] / b[r];
+                break;
+            }
+            case NodeKind::Power:
+                for (size_t r = 0; r < n; ++r) {
+                    out[r] = detail::pow(a[r], b[r]);
+                }
+                break;
+            case NodeKind::Sin:
+                for (size_t r = 0; r < n; ++r) {
+                    out[r] = detail::sin(a[r]);
+                }
+                break;
+            case NodeKind::Cos:
+                for (size_t r = 0; r < n; ++r) {
+                    out[r] = detail::cos(a[r]);
+                }
+                break;
+            case NodeKind::Ln:
+                if constexpr (!std::is_same_v<_Domain, Complexes_t>) {
+                    bool domain_error = false;
+                    for (size_t r = 0; r < n; ++r) {
+                        domain_error |= detail::outside_log_domain(a[r]);
+                    }
+                    if (domain_error) {
+                        profile::count(profile::Counter::Exceptions);
+                        throw std::runtime_error("Ln domain error");
+                    }
+                }
+                for (size_t r = 0; r < n; ++r) {
+                    out[r] = detail::log(a[r]);
+                }
+                break;
+            case NodeKind::Exp:
+                for (size_t r = 0; r < n; ++r) {
+                    out[r] = detail::exp(a[r]);
+                }
+                break;
+        }
+    }
+}
+
+namespace detail {
+template <typename T>
+void write_pod(std::ostream& os, const T& value) {
+    os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T read_pod(std::istream& is) {
+    T value;
+    if (!is.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+        throw std::runtime_error("Truncated compiled expression");
+    }
+    return value;
+}
+
+inline void write_string(std::ostream& os, const std::string& str) {
+    write_pod<uint32_t>(os, str.size());
+    os.write(str.data(), str.size());
+}
+
+inline std::string read_string(std::istream& is) {
+    uint32_t size = read_pod<uint32_t>(is);
+    std::string str(size, '\0');
+    if (!is.read(str.data(), size)) {
+        throw std::runtime_error("Truncated compiled expression");
+    }
+    return str;
+}
+
+inline constexpr char compiled_magic[4] = {'S', 'Y', 'M', 'C'};
+inline constexpr uint32_t compiled_version = 1;
+
+inline std::string read_compiled_header(std::istream& is) {
+    char magic[4];
+    if (!is.read(magic, 4) || std::memcmp(magic, compiled_magic, 4) != 0) {
+        throw std::runtime_error("Not a compiled expression");
+    }
+    if (read_pod<uint32_t>(is) != compiled_version) {
+        throw std::runtime_error("Unsupported compiled expression version");
+    }
+    return read_string(is);
+}
+};  // namespace detail
+
+inline std::string compiled_domain(std::istream& is) {
+    auto start = is.tellg();
+    std::string domain = detail::read_compiled_header(is);
+    is.seekg(start);
+    return domain;
+}
+
+template <Numeric _Domain>
+void CompiledExpression<_Domain>::save(std::ostream& os) const {
+    if (!DomainName<_Domain>::value) {
+        throw std::runtime_error("Domain cannot be serialized");
+    }
+    os.write(detail::compiled_magic, 4);
+    detail::write_pod(os, detail::compiled_version);
+    detail::write_string(os, DomainName<_Domain>::value);
+    detail::write_pod<uint32_t>(os, sizeof(_Domain));
+
+    detail::write_pod<uint32_t>(os, variable_names.size());
+    for (const auto& name : variable_names) {
+        detail::write_string(os, name);
+    }
+    detail::write_pod<uint32_t>(os, constant_pool.size());
+    for (const auto& value : constant_pool) {
+        detail::write_pod(os, value);
+    }
+    detail::write_pod<uint32_t>(os, code.size());
+    for (const auto& instruction : code) {
+        detail::write_pod<uint8_t>(os, static_cast<uint8_t>(instruction.kind));
+        detail::write_pod(os, instruction.lhs);
+        detail::write_pod(os, instruction.rhs);
+    }
+    detail::write_pod<uint32_t>(os, output_registers.size());
+    for (size_t k = 0; k < output_registers.size(); ++k) {
+        detail::write_pod(os, output_registers[k]);
+        detail::write_string(os, output_labels[k]);
+    }
+    if (!os) {
+        throw std::runtime_error("Cannot write compiled expression");
+    }
+}
+
+template <Numeric _Domain>
+CompiledExpression<_Domain> CompiledExpression<_Domain>::load(
+    std::istream& is) {
+    std::string domain = detail::read_compiled_header(is);
+    if (!DomainName<_Domain>::value || domain != DomainName<_Domain>::value ||
+        detail::read_pod<uint32_t>(is) != sizeof(_Domain)) {
+        throw std::runtime_error("Compiled expression domain mismatch: " +
+                                 domain);
+    }
+
+    CompiledExpression compiled;
+    compiled.variable_names.resize(detail::read_pod<uint32_t>(is));
+    for (auto& name : compiled.variable_names) {
+        name = detail::read_string(is);
+    }
+    compiled.constant_pool.resize(detail::read_pod<uint32_t>(is));
+    for (auto& value : compiled.constant_pool) {
+        value = detail::read_pod<_Domain>(is);
+    }
+    compiled.code.resize(detail::read_pod<uint32_t>(is));
+    for (auto& instruction : compiled.code) {
+        uint8_t kind = detail::read_pod<uint8_t>(is);
+        if (kind >= node_kind_count) {
+            throw std::runtime_error("Invalid compiled instruction");
+        }
+        instruction.kind = static_cast<NodeKind>(kind);
+        instruction.lhs = detail::read_pod<uint32_t>(is);
+        instruction.rhs = detail::read_pod<uint32_t>(is);
+    }
+    size_t outputs = detail::read_pod<uint32_t>(is);
+    for (size_t k = 0; k < outputs; ++k) {
+        compiled.output_registers.push_back(detail::read_pod<uint32_t>(is));
+        compiled.output_labels.push_back(detail::read_string(is));
+    }
+    compiled.validate();
+    return compiled;
+}
+
+template <Numeric _Domain>
+void CompiledExpression<_Domain>::validate() const {
+    for (size_t i = 0; i < code.size(); ++i) {
+        const Instruction& instruction = code[i];
+        size_t arity = node_kind_arity(instruction.kind);
+        bool valid =
+            instruction.kind == NodeKind::Value
+                ? instruction.lhs < constant_pool.size()
+            : instruction.kind == NodeKind::Variable
+                ? instruction.lhs < variable_names.size()
+                : instruction.lhs < i && (arity < 2 || instruction.rhs < i);
+        if (!valid) {
+            throw std::runtime_error("Invalid compiled instruction");
+        }
+    }
+    for (uint32_t reg : output_registers) {
+        if (reg >= code.size()) {
+            throw std::runtime_error("Invalid compiled output");
+        }
+    }
+}
+
+};  // namespace symcpp
+
+#endif  // COMPILED_HPP
@@ -0,0 +1,261 @@
+#ifndef COMPLEX_BATCH_HPP
+#define COMPLEX_BATCH_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "compiled.hpp"
+#include "profile.hpp"
+
+namespace symcpp {
+class ComplexBatchEvaluator {
+   public:
+    static constexpr size_t block_size = 256;
+
+    struct Workspace {
+        std::vector<double> re, im;
+        std::vector<const double*> re_registers, im_registers;
+    };
+
+    ComplexBatchEvaluator() = default;
+    explicit ComplexBatchEvaluator(
+        const CompiledExpression<Complexes_t>& compiled,
+        bool limited_range = false)
+        : variable_names(compiled.variables()),
+          code(compiled.instructions()),
+          output_registers(compiled.outputs()),
+          limited_range(limited_range) {
+        for (const auto& value : compiled.constants()) {
+            constant_re.push_back(static_cast<double>(value.real()));
+            constant_im.push_back(static_cast<double>(value.imag()));
+        }
+    }
+
+    const std::vector<std::string>& variables() const {
+        return variable_names;
+    }
+    size_t outputs() const { return output_registers.size(); }
+
+    void eval_batch(const double* const* re, const double* const* im,
+                    size_t rows, double* const* out_re, double* const* out_im,
+                    Workspace& workspace) const {
+        for (size_t offset = 0; offset < rows; offset += block_size) {
+            size_t n = std::min(block_size, rows - offset);
+            execute(re, im, offset, n, workspace);
+            for (size_t k = 0; k < output_registers.size(); ++k) {
+                uint32_t reg = output_registers[k];
+                std::copy_n(workspace.re_registers[reg], n,
+                            out_re[k] + offset);
+                std::copy_n(workspace.im_registers[reg], n,
+                            out_im[k] + offset);
+            }
+        }
+    }
+
+   private:
+    void execute(const double* const* re, const double* const* im,
+                 size_t offset, size_t n, Workspace& workspace) const {
+        profile::count(profile::Counter::Evaluations, code.size() * n);
+        workspace.re.resize(code.size() * n);
+        workspace.im.resize(code.size() * n);
+        workspace.re_registers.resize(code.size());
+        workspace.im_registers.resize(code.size());
+
+        for (size_t i = 0; i < code.size(); ++i) {
+            const Instruction& instruction = code[i];
+            size_t arity = node_kind_arity(instruction.kind);
+            double* zr = workspace.re.data() + i * n;
+            double* zi = workspace.im.data() + i * n;
+            const double* ar = nullptr;
+            const double* ai = nullptr;
+            const double* br = nullptr;
+            const double* bi = nullptr;
+            if (arity > 0) {
+                ar = workspace.re_registers[instruction.lhs];
+                ai = workspace.im_registers[instruction.lhs];
+            }
+            if (arity > 1) {
+                br = workspace.re_registers[instruction.rhs];
+                bi = workspace.im_registers[instruction.rhs];
+            }
+            workspace.re_registers[i] = zr;
+            workspace.im_registers[i] = zi;
+
+            switch (instruction.kind) {
+                case NodeKind::Value:
+                    std::fill_n(zr, n, constant_re[instruction.lhs]);
+                    std::fill_n(zi, n, constant_im[instruction.lhs]);
+                    break;
+                case NodeKind::Variable:
+                    workspace.re_registers[i] = re[instruction.lhs] + offset;
+                    workspace.im_registers[i] = im[instruction.lhs] + offset;
+                    break;
+                case NodeKind::Add:
+                    for (size_t r = 0; r < n; ++r) {
+                        zr[r] = ar[r] + br[r];
+                        zi[r] = ai[r] + bi[r];
+                    }
+                    break;
+                case NodeKind::Subtract:
+                    for (size_t r = 0; r < n; ++r) {
+                        zr[r] = ar[r] - br[r];
+                        zi[r] = ai[r] - bi[r];
+                    }
+                    break;
+                case NodeKind::Multiply:
+                    multiply(n, ar, ai, br, bi, zr, zi);
+                    break;
+                case NodeKind::Divide:
+                    divide(n, ar, ai, br, bi, zr, zi);
+                    break;
+                case NodeKind::Power:
+                    power(n, ar, ai, br, bi, zr, zi);
+                    break;
+                case NodeKind::Sin:
+                    for (size_t r = 0; r < n; ++r) {
+                        zr[r] = std::sin(ar[r]) * std::cosh(ai[r]);
+                        zi[r] = std::cos(ar[r]) * std::sinh(ai[r]);
+                    }
+                    break;
+                case NodeKind::Cos:
+                    for (size_t r = 0; r < n; ++r) {
+                        zr[r] = std::cos(ar[r]) * std::cosh(ai[r]);
+                        zi[r] = -std::sin(ar[r]) * std::sinh(ai[r]);
+                    }
+                    break;
+                case NodeKind::Ln:
+                    log(n, ar, ai, zr, zi);
+                    break;
+                case NodeKind::Exp:
+                    for (size_t r = 0; r < n; ++r) {
+                        double scale = std::exp(ar[r]);
+                        zr[r] = scale * std::cos(ai[r]);
+                        zi[r] = scale * std::sin(ai[r]);
+                    }
+                    break;
+            }
+        }
+    }
+
+    void multiply(size_t n, const double* ar, const double* ai,
+                  const double* br, const double* bi, double* zr,
+                  double* zi) const {
+        for (size_t r = 0; r < n; ++r) {
+            double re = ar[r] * br[r] - ai[r] * bi[r];
+            double im = ar[r] * bi[r] + ai[r] * br[r];
+            zr[r] = re;
+            zi[r] = im;
+        }
+        if (limited_range) {
+            return;
+        }
+        for (size_t r = 0; r < n; ++r) {
+            if (std::isnan(zr[r]) && std::isnan(zi[r])) {
+                std::complex<double> z = std::complex<double>(ar[r], ai[r]) *
+                                         std::complex<double>(br[r], bi[r]);
+                zr[r] = z.real();
+                zi[r] = z.imag();
+            }
+        }
+    }
+
+    void divide(size_t n, const double* ar, const double* ai,
+                const double* br, const double* bi, double* zr,
+                double* zi) const {
+        bool zero = false;
+        for (size_t r = 0; r < n; ++r) {
+            zero |= br[r] == 0 && bi[r] == 0;
+        }
+        if (zero) {
+            profile::count(profile::Counter::Exceptions);
+            throw std::runtime_error("Division by zero");
+        }
+
+        if (limited_range) {
+            for (size_t r = 0; r < n; ++r) {
+                double scale = 1 / (br[r] * br[r] + bi[r] * bi[r]);
+                double re = (ar[r] * br[r] + ai[r] * bi[r]) * scale;
+                double im = (ai[r] * br[r] - ar[r] * bi[r]) * scale;
+                zr[r] = re;
+                zi[r] = im;
+            }
+            return;
+        }
+
+        for (size_t r = 0; r < n; ++r) {
+            bool wide = std::fabs(br[r]) >= std::fabs(bi[r]);
+            double ratio = wide ? bi[r] / br[r] : br[r] / bi[r];
+            double denominator =
+                wide ? br[r] + bi[r] * ratio : br[r] * ratio + bi[r];
+            double re = wide ? ar[r] + ai[r] * ratio : ar[r] * ratio + ai[r];
+            double im = wide ? ai[r] - ar[r] * ratio : ai[r] * ratio - ar[r];
+            zr[r] = re / denominator;
+            zi[r] = im / denominator;
+        }
+        for (size_t r = 0; r < n; ++r) {
+            if (std::isnan(zr[r]) && std::isnan(zi[r])) {
+                std::complex<double> z = std::complex<double>(ar[r], ai[r]) /
+                                         std::complex<double>(br[r], bi[r]);
+                zr[r] = z.real();
+                zi[r] = z.imag();
+            }
+        }
+    }
+
+    void log(size_t n, const double* ar, const double* ai, double* zr,
+             double* zi) const {
+        if (limited_range) {
+            for (size_t r = 0; r < n; ++r) {
+                zr[r] = 0.5 * std::log(ar[r] * ar[r] + ai[r] * ai[r]);
+            }
+        } else {
+            for (size_t r = 0; r < n; ++r) {
+                zr[r] = std::log(std::hypot(ar[r], ai[r]));
+            }
+        }
+        for (size_t r = 0; r < n; ++r) {
+            zi[r] = std::atan2(ai[r], ar[r]);
+        }
+    }
+
+    void power(size_t n, const double* ar, const double* ai,
+               const double* br, const double* bi, double* zr,
+               double* zi) const {
+        bool zero = false;
+        for (size_t r = 0; r < n; ++r) {
+            zero |= ar[r] == 0 && ai[r] == 0;
+            double log_re = std::log(std::hypot(ar[r], ai[r]));
+            double log_im = std::atan2(ai[r], ar[r]);
+            double scale = std::exp(br[r] * log_re - bi[r] * log_im);
+            double angle = br[r] * log_im + bi[r] * log_re;
+            zr[r] = scale * std::cos(angle);
+            zi[r] = scale * std::sin(angle);
+        }
+        if (!zero) {
+            return;
+        }
+        for (size_t r = 0; r < n; ++r) {
+            if (ar[r] == 0 && ai[r] == 0) {
+                std::complex<double> z =
+                    std::pow(std::complex<double>(ar[r], ai[r]),
+                             std::complex<double>(br[r], bi[r]));
+                zr[r] = z.real();
+                zi[r] = z.imag();
+            }
+        }
+    }
+
+    std::vector<std::string> variable_names;
+    std::vector<double> constant_re, constant_im;
+    std::vector<Instruction> code;
+    std::vector<uint32_t> output_registers;
+    bool limited_range = false;
+};
+
+};  // namespace symcpp
+
+#endif  // COMPLEX_BATCH_HPP
@@ -0,0 +1,131 @@
+#ifndef DENSE_HPP
+#define DENSE_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace symcpp {
+template <typename T>
+class LuFactorization {
+   public:
+    size_t size() const { return n; }
+
+    bool factor(const T* matrix, size_t size) {
+        using std::fabs;
+        n = size;
+        lu.assign(matrix, matrix + n * n);
+        pivots.resize(n);
+        for (size_t k = 0; k < n; ++k) {
+            size_t pivot = k;
+            for (size_t i = k + 1; i < n; ++i) {
+                if (fabs(lu[i * n + k]) > fabs(lu[pivot * n + k])) {
+                    pivot = i;
+                }
+            }
+            pivots[k] = static_cast<uint32_t>(pivot);
+            if (!(fabs(lu[pivot * n + k]) > 0)) {
+                return false;
+            }
+            if (pivot != k) {
+                for (size_t j = 0; j < n; ++j) {
+                    std::swap(lu[k * n + j], lu[pivot * n + j]);
+                }
+            }
+            T inverse = T(1) / lu[k * n + k];
+            for (size_t i = k + 1; i < n; ++i) {
+                T factor = lu[i * n + k] *= inverse;
+                const T* top = lu.data() + k * n;
+                T* row = lu.data() + i * n;
+                for (size_t j = k + 1; j < n; ++j) {
+                    row[j] -= factor * top[j];
+                }
+            }
+        }
+        return true;
+    }
+
+    void solve(T* x) const {
+        for (size_t k = 0; k < n; ++k) {
+            std::swap(x[k], x[pivots[k]]);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            const T* row = lu.data() + i * n;
+            for (size_t j = 0; j < i; ++j) {
+                x[i] -= row[j] * x[j];
+            }
+        }
+        for (size_t i = n; i-- > 0;) {
+            const T* row = lu.data() + i * n;
+            for (size_t j = i + 1; j < n; ++j) {
+                x[i] -= row[j] * x[j];
+            }
+            x[i] /= row[i];
+        }
+    }
+
+    void solve_transposed(T* x) const {
+        for (size_t i = 0; i < n; ++i) {
+            x[i] /= lu[i * n + i];
+            for (size_t j = i + 1; j < n; ++j) {
+                x[j] -= lu[i * n + j] * x[i];
+            }
+        }
+        for (size_t i = n; i-- > 0;) {
+            for (size_t j = 0; j < i; ++j) {
+                x[j] -= lu[i * n + j] * x[i];
+            }
+        }
+        for (size_t k = n; k-- > 0;) {
+            std::swap(x[k], x[pivots[k]]);
+        }
+    }
+
+   private:
+    size_t n = 0;
+    std::vector<T> lu;
+    std::vector<uint32_t> pivots;
+};
+
+template <typename T>
+bool cholesky_solve(std::vector<T>& matrix, size_t n, T* x) {
+    using std::sqrt;
+    for (size_t j = 0; j < n; ++j) {
+        T* row = matrix.data() + j * n;
+        T diagonal = row[j];
+        for (size_t k = 0; k < j; ++k) {
+            diagonal -= row[k] * row[k];
+        }
+        if (!(diagonal > 0)) {
+            return false;
+        }
+        row[j] = sqrt(diagonal);
+        for (size_t i = j + 1; i < n; ++i) {
+            T* other = matrix.data() + i * n;
+            T sum = other[j];
+            for (size_t k = 0; k < j; ++k) {
+                sum -= other[k] * row[k];
+            }
+            other[j] = sum / row[j];
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        const T* row = matrix.data() + i * n;
+        for (size_t k = 0; k < i; ++k) {
+            x[i] -= row[k] * x[k];
+        }
+        x[i] /= row[i];
+    }
+    for (size_t i = n; i-- > 0;) {
+        for (size_t k = i + 1; k < n; ++k) {
+            x[i] -= matrix[k * n + i] * x[k];
+        }
+        x[i] /= matrix[i * n + i];
+    }
+    return true;
+}
+
+};  // namespace symcpp
+
+#endif  // DENSE_HPP
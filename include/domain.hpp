@@ -0,0 +1,54 @@
+#ifndef DOMAIN_HPP
+#define DOMAIN_HPP
+
+#include <cmath>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "expression.hpp"
+
+namespace symcpp {
+template <Numeric _Domain>
+bool requires_complex(const Expression<_Domain>& expr,
+                      const std::map<std::string, Complexes_t>& inputs) {
+    std::vector<const Expression<_Domain>*> pending = {&expr};
+    std::unordered_set<const void*> visited;
+    while (!pending.empty()) {
+        const Expression<_Domain>& node = *pending.back();
+        pending.pop_back();
+        if (!visited.insert(node.id()).second) {
+            continue;
+        }
+
+        switch (node.kind()) {
+            case NodeKind::Value:
+                if constexpr (std::is_floating_point_v<_Domain> ||
+                              std::is_same_v<_Domain, DoubleDouble>) {
+                    using std::isnan;
+                    if (isnan(node.value())) {
+                        return true;
+                    }
+                }
+                break;
+            case NodeKind::Variable: {
+                auto it = inputs.find(node.name());
+                if (it == inputs.end() ? node.name() == "i"
+                                       : it->second.imag() != 0) {
+                    return true;
+                }
+                break;
+            }
+            default:
+                for (size_t k = 0; k < node.arity(); ++k) {
+                    pending.push_back(&node.operand(k));
+                }
+        }
+    }
+    return false;
+}
+
+};  // namespace symcpp
+
+#endif  // DOMAIN_HPP
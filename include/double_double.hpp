@@ -0,0 +1,452 @@
+#ifndef DOUBLE_DOUBLE_HPP
+#define DOUBLE_DOUBLE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace symcpp {
+class DoubleDouble {
+   public:
+    DoubleDouble() = default;
+    template <typename U>
+        requires std::is_arithmetic_v<U>
+    DoubleDouble(U value) {
+        if constexpr (std::is_floating_point_v<U> &&
+                      sizeof(U) <= sizeof(double)) {
+            hi = static_cast<double>(value);
+        } else {
+            long double wide = static_cast<long double>(value);
+            hi = static_cast<double>(wide);
+            lo = std::isfinite(hi) ? static_cast<double>(wide - hi) : 0.0;
+        }
+    }
+    DoubleDouble(double hi, double lo) : hi(hi), lo(lo) {}
+
+    explicit operator float() const { return static_cast<float>(hi); }
+    explicit operator double() const { return hi; }
+    explicit operator long double() const {
+        return static_cast<long double>(hi) + lo;
+    }
+
+    double high() const { return hi; }
+    double low() const { return lo; }
+
+    static DoubleDouble pi() {
+        return DoubleDouble(3.141592653589793116e+00, 1.224646799147353207e-16);
+    }
+    static DoubleDouble ln2() {
+        return DoubleDouble(6.931471805599452862e-01, 2.319046813846299558e-17);
+    }
+
+    static DoubleDouble parse(const std::string& str) {
+        size_t pos = 0;
+        bool negative = false;
+        if (pos < str.size() && (str[pos] == '+' || str[pos] == '-')) {
+            negative = str[pos++] == '-';
+        }
+        DoubleDouble mantissa;
+        int exponent = 0;
+        bool digits = false, point = false;
+        for (; pos < str.size(); ++pos) {
+            char c = str[pos];
+            if (c >= '0' && c <= '9') {
+                mantissa = mantissa * 10 + (c - '0');
+                exponent -= point;
+                digits = true;
+            } else if (c == '.' && !point) {
+                point = true;
+            } else {
+                break;
+            }
+        }
+        if (digits && pos < str.size() &&
+            (str[pos] == 'e' || str[pos] == 'E')) {
+            size_t used = 0;
+            try {
+                exponent += std::stoi(str.substr(pos + 1), &used);
+            } catch (const std::exception&) {
+                used = 0;
+            }
+            pos += used ? used + 1 : 0;
+        }
+        if (!digits || pos != str.size()) {
+            throw std::runtime_error("Invalid number: " + str);
+        }
+        DoubleDouble scale = power(DoubleDouble(10), std::abs(exponent));
+        mantissa = exponent < 0 ? mantissa / scale : mantissa * scale;
+        return negative ? -mantissa : mantissa;
+    }
+
+    friend bool operator==(const DoubleDouble& lhs, const DoubleDouble& rhs) {
+        return lhs.hi == rhs.hi && lhs.lo == rhs.lo;
+    }
+    friend bool operator<(const DoubleDouble& lhs, const DoubleDouble& rhs) {
+        return lhs.hi < rhs.hi || (lhs.hi == rhs.hi && lhs.lo < rhs.lo);
+    }
+    friend bool operator>(const DoubleDouble& lhs, const DoubleDouble& rhs) {
+        return rhs < lhs;
+    }
+    friend bool operator<=(const DoubleDouble& lhs, const DoubleDouble& rhs) {
+        return lhs.hi < rhs.hi || (lhs.hi == rhs.hi && lhs.lo <= rhs.lo);
+    }
+    friend bool operator>=(const DoubleDouble& lhs, const DoubleDouble& rhs) {
+        return rhs <= lhs;
+    }
+
+    friend DoubleDouble operator-(const DoubleDouble& x) {
+        return DoubleDouble(-x.hi, -x.lo);
+    }
+
+    friend DoubleDouble operator+(const DoubleDouble& lhs,
+                                  const DoubleDouble& rhs) {
+        auto [s, e] = two_sum(lhs.hi, rhs.hi);
+        auto [t, f] = two_sum(lhs.lo, rhs.lo);
+        double sum = s;
+        e += t;
+        quick_two_sum(s, e);
+        e += f;
+        quick_two_sum(s, e);
+        return finite_or(sum, s, e);
+    }
+
+    friend DoubleDouble operator-(const DoubleDouble& lhs,
+                                  const DoubleDouble& rhs) {
+        return lhs + -rhs;
+    }
+
+    friend DoubleDouble operator*(const DoubleDouble& lhs,
+                                  const DoubleDouble& rhs) {
+        double p = lhs.hi * rhs.hi;
+        double product = p;
+        double e = product_error(lhs.hi, rhs.hi, p);
+        e += lhs.hi * rhs.lo + lhs.lo * rhs.hi;
+        quick_two_sum(p, e);
+        return finite_or(product, p, e);
+    }
+
+    friend DoubleDouble operator/(const DoubleDouble& lhs,
+                                  const DoubleDouble& rhs) {
+        double inverse = 1.0 / rhs.hi;
+        double q = lhs.hi * inverse;
+        double quotient = q;
+        DoubleDouble r = lhs - rhs * q;
+        double e = r.hi * inverse;
+        quick_two_sum(q, e);
+        return finite_or(quotient, q, e);
+    }
+
+    DoubleDouble& operator+=(const DoubleDouble& other) {
+        return *this = *this + other;
+    }
+    DoubleDouble& operator-=(const DoubleDouble& other) {
+        return *this = *this - other;
+    }
+    DoubleDouble& operator*=(const DoubleDouble& other) {
+        return *this = *this * other;
+    }
+    DoubleDouble& operator/=(const DoubleDouble& other) {
+        return *this = *this / other;
+    }
+
+    friend bool isnan(const DoubleDouble& x) { return std::isnan(x.hi); }
+    friend bool isfinite(const DoubleDouble& x) { return std::isfinite(x.hi); }
+    friend DoubleDouble fabs(const DoubleDouble& x) {
+        return x.hi < 0 ? -x : x;
+    }
+
+    friend DoubleDouble exp(const DoubleDouble& x) {
+        if (std::isnan(x.hi)) {
+            return x;
+        }
+        if (x.hi > 709.79) {
+            return DoubleDouble(std::numeric_limits<double>::infinity(), 0);
+        }
+        if (x.hi < -745.2) {
+            return DoubleDouble();
+        }
+        double n = nearest(x.hi * (exp_steps / ln2().hi));
+        DoubleDouble r = x - ln2() * (n / exp_steps);
+        auto k = static_cast<int64_t>(n);
+        int64_t j = k & (exp_steps - 1);
+        const DoubleDouble& base = powers_of_two()[j];
+        DoubleDouble sum = base + base * (polynomial(r, 1, 1, 12, 6) * r);
+        int scale = static_cast<int>((k - j) / exp_steps);
+        return DoubleDouble(std::ldexp(sum.hi, scale),
+                            std::ldexp(sum.lo, scale));
+    }
+
+    friend DoubleDouble log(const DoubleDouble& x) {
+        if (std::isnan(x.hi) || x.hi < 0) {
+            return DoubleDouble(std::numeric_limits<double>::quiet_NaN(), 0);
+        }
+        if (x.hi == 0) {
+            return DoubleDouble(-std::numeric_limits<double>::infinity(), 0);
+        }
+        if (std::isinf(x.hi)) {
+            return x;
+        }
+        DoubleDouble y = std::log(x.hi);
+        return y + x * exp(-y) - 1;
+    }
+
+    friend DoubleDouble sin(const DoubleDouble& x) { return sine(x, 0); }
+
+    friend DoubleDouble cos(const DoubleDouble& x) { return sine(x, 1); }
+
+    friend DoubleDouble pow(const DoubleDouble& x, const DoubleDouble& y) {
+        if (y.lo == 0 && y.hi == std::trunc(y.hi) &&
+            std::fabs(y.hi) < 9007199254740992.0) {
+            DoubleDouble result = power(x, std::fabs(y.hi));
+            return y.hi < 0 ? DoubleDouble(1) / result : result;
+        }
+        if (x.hi == 0 && x.lo == 0) {
+            return y.hi > 0 ? DoubleDouble()
+                            : DoubleDouble(
+                                  std::numeric_limits<double>::infinity(), 0);
+        }
+        return exp(y * log(x));
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const DoubleDouble& x) {
+        return os << x.to_string(os.precision() > 0 ? os.precision() : 6);
+    }
+
+    std::string to_string(int digits = 32) const {
+        if (std::isnan(hi)) {
+            return "nan";
+        }
+        if (std::isinf(hi)) {
+            return hi < 0 ? "-inf" : "inf";
+        }
+        if (hi == 0) {
+            return "0";
+        }
+
+        DoubleDouble r = fabs(*this);
+        int exponent = static_cast<int>(std::floor(std::log10(r.hi)));
+        DoubleDouble scale = power(DoubleDouble(10), std::abs(exponent));
+        r = exponent < 0 ? r * scale : r / scale;
+        if (r >= DoubleDouble(10)) {
+            r = r / 10;
+            ++exponent;
+        } else if (r < DoubleDouble(1)) {
+            r = r * 10;
+            --exponent;
+        }
+
+        std::string mantissa;
+        for (int i = 0; i <= digits; ++i) {
+            int digit = static_cast<int>(std::floor(r.hi));
+            if (digit == r.hi && r.lo < 0) {
+                --digit;
+            }
+            digit = std::min(9, std::max(0, digit));
+            mantissa.push_back(static_cast<char>('0' + digit));
+            r = (r - digit) * 10;
+        }
+        bool carry = mantissa.back() >= '5';
+        mantissa.pop_back();
+        for (size_t i = mantissa.size(); carry && i-- > 0;) {
+            carry = mantissa[i] == '9';
+            mantissa[i] = carry ? '0' : mantissa[i] + 1;
+        }
+        if (carry) {
+            mantissa.insert(mantissa.begin(), '1');
+            mantissa.pop_back();
+            ++exponent;
+        }
+
+        size_t last = mantissa.find_last_not_of('0');
+        mantissa.erase(last + 1);
+        std::string text;
+        if (exponent < 0) {
+            text = "0." + std::string(-exponent - 1, '0') + mantissa;
+        } else if (size_t(exponent) + 1 >= mantissa.size()) {
+            text = mantissa + std::string(exponent + 1 - mantissa.size(), '0');
+        } else {
+            text = mantissa.substr(0, exponent + 1) + "." +
+                   mantissa.substr(exponent + 1);
+        }
+        return hi < 0 ? "-" + text : text;
+    }
+
+   private:
+    static constexpr int series_terms = 29;
+    static constexpr int64_t exp_steps = 64;
+    static constexpr int sin_steps = 64;
+
+    static const std::array<DoubleDouble, series_terms + 2>&
+    inverse_factorials() {
+        static const auto table = [] {
+            std::array<DoubleDouble, series_terms + 2> inverse;
+            inverse[0] = 1;
+            for (int n = 1; n < series_terms + 2; ++n) {
+                inverse[n] = inverse[n - 1] / n;
+            }
+            return inverse;
+        }();
+        return table;
+    }
+
+    static const std::array<DoubleDouble, exp_steps>& powers_of_two() {
+        static const auto table = [] {
+            const auto& inverse = inverse_factorials();
+            std::array<DoubleDouble, exp_steps> powers;
+            for (int64_t j = 0; j < exp_steps; ++j) {
+                DoubleDouble r = ln2() * (double(j) / exp_steps);
+                DoubleDouble sum = inverse[series_terms];
+                for (int n = series_terms - 1; n >= 0; --n) {
+                    sum = sum * r + inverse[n];
+                }
+                powers[j] = sum;
+            }
+            return powers;
+        }();
+        return table;
+    }
+
+    static const std::array<std::pair<DoubleDouble, DoubleDouble>,
+                            sin_steps + 1>&
+    sines_cosines() {
+        static const auto table = [] {
+            std::array<std::pair<DoubleDouble, DoubleDouble>, sin_steps + 1>
+                values;
+            for (int i = 0; i <= sin_steps; ++i) {
+                DoubleDouble a = pi() * (i / (4.0 * sin_steps));
+                values[i] = {sin_series(a), cos_series(a)};
+            }
+            return values;
+        }();
+        return table;
+    }
+
+    static DoubleDouble polynomial(const DoubleDouble& z, size_t first,
+                                   size_t stride, size_t size,
+                                   size_t split) {
+        const auto& inverse = inverse_factorials();
+        auto c = [&](size_t k) { return inverse[first + k * stride]; };
+        double tail = c(size - 1).hi;
+        for (size_t k = size - 1; k-- > split;) {
+            tail = tail * z.hi + c(k).hi;
+        }
+        DoubleDouble sum = tail;
+        for (size_t k = split; k-- > 0;) {
+            sum = sum * z + c(k);
+        }
+        return sum;
+    }
+
+    static double product_error(double a, double b, double p) {
+#ifdef FP_FAST_FMA
+        return std::fma(a, b, -p);
+#else
+        auto [a_hi, a_lo] = split(a);
+        auto [b_hi, b_lo] = split(b);
+        return ((a_hi * b_hi - p) + a_hi * b_lo + a_lo * b_hi) + a_lo * b_lo;
+#endif
+    }
+
+    static std::pair<double, double> split(double a) {
+        double c = 134217729.0 * a;
+        double hi = c - (c - a);
+        return {hi, a - hi};
+    }
+
+    static DoubleDouble finite_or(double estimate, double hi, double lo) {
+        bool finite = std::isfinite(estimate);
+        return DoubleDouble(finite ? hi : estimate, finite ? lo : 0.0);
+    }
+
+    static std::pair<double, double> two_sum(double a, double b) {
+        double s = a + b;
+        double b_virtual = s - a;
+        return {s, (a - (s - b_virtual)) + (b - b_virtual)};
+    }
+
+    static void quick_two_sum(double& s, double& e) {
+        double sum = s + e;
+        e = e - (sum - s);
+        s = sum;
+    }
+
+    static DoubleDouble power(DoubleDouble base, double n) {
+        DoubleDouble result = 1;
+        while (n >= 1) {
+            if (std::fmod(n, 2.0) == 1) {
+                result *= base;
+            }
+            n = std::floor(n / 2);
+            if (n >= 1) {
+                base *= base;
+            }
+        }
+        return result;
+    }
+
+    static double nearest(double x) {
+        constexpr double shifter = 0x1.8p52;
+        return std::fabs(x) < 0x1p51 ? (x + shifter) - shifter
+                                     : std::nearbyint(x);
+    }
+
+    static DoubleDouble sine(const DoubleDouble& x, int shift) {
+        if (!std::isfinite(x.hi)) {
+            return DoubleDouble(std::numeric_limits<double>::quiet_NaN(), 0);
+        }
+        DoubleDouble half_pi = DoubleDouble(std::ldexp(pi().hi, -1),
+                                            std::ldexp(pi().lo, -1));
+        double j = nearest(x.hi / half_pi.hi);
+        DoubleDouble t = x - half_pi * j;
+        double i = std::clamp(nearest(t.hi * (4 * sin_steps / pi().hi)),
+                              -double(sin_steps), double(sin_steps));
+        DoubleDouble u = t - pi() * (i / (4 * sin_steps));
+        DoubleDouble z = -(u * u);
+        DoubleDouble su = polynomial(z, 1, 2, 7, 3) * u;
+        DoubleDouble cu = polynomial(z, 0, 2, 7, 3);
+        const auto& [sa, ca] =
+            sines_cosines()[static_cast<size_t>(std::fabs(i))];
+        DoubleDouble s = i < 0 ? -sa : sa;
+
+        double turns = std::fabs(j) < 0x1p51 ? j : std::fmod(j, 4.0);
+        auto quadrant = (static_cast<int64_t>(turns) + shift) & 3;
+        bool odd = quadrant & 1;
+        DoubleDouble result = (odd ? ca : s) * cu + (odd ? -s : ca) * su;
+        return quadrant & 2 ? -result : result;
+    }
+
+    static DoubleDouble sin_series(const DoubleDouble& t) {
+        const auto& inverse = inverse_factorials();
+        DoubleDouble t2 = t * t;
+        DoubleDouble sum = inverse[series_terms];
+        for (int n = series_terms - 2; n > 0; n -= 2) {
+            sum = inverse[n] - sum * t2;
+        }
+        return sum * t;
+    }
+
+    static DoubleDouble cos_series(const DoubleDouble& t) {
+        const auto& inverse = inverse_factorials();
+        DoubleDouble t2 = t * t;
+        DoubleDouble sum = inverse[series_terms + 1];
+        for (int n = series_terms - 1; n >= 0; n -= 2) {
+            sum = inverse[n] - sum * t2;
+        }
+        return sum;
+    }
+
+    double hi = 0;
+    double lo = 0;
+};
+
+inline std::string to_string(const DoubleDouble& x) { return x.to_string(); }
+
+};  // namespace symcpp
+
+#endif  // DOUBLE_DOUBLE_HPP
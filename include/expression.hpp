@@ -1,15 +1,28 @@
 #ifndef EXPRESSION_HPP
 #define EXPRESSION_HPP
 
+#include <charconv>
 #include <cmath>
 #include <complex>
+#include <cstdint>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <memory>
+#include <set>
 #include <stack>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+#include "allocation.hpp"
+#include "double_double.hpp"
+#include "format.hpp"
+#include "interval.hpp"
+#include "node_kind.hpp"
+#include "profile.hpp"
 
 namespace symcpp {
 using Reals_t = long double;
@@ -24,15 +37,128 @@ class Complexes_t : public std::complex<Reals_t> {
         : std::complex<Reals_t>(other) {}
 };
 
-std::string to_string(const Complexes_t& c) {
-    return "(" + std::to_string(c.real()) + ", " + std::to_string(c.imag()) +
-           ")";
+inline std::string to_string(const Complexes_t& c) {
+    return "(" + detail::format_number(c.real()) + ", " +
+           detail::format_number(c.imag()) + ")";
 }
 
 template <typename T>
 concept Numeric =
     std::is_arithmetic_v<T> || std::is_same_v<T, std::complex<long double>> ||
-    std::is_same_v<T, Complexes_t>;
+    std::is_same_v<T, Complexes_t> || std::is_same_v<T, DoubleDouble> ||
+    is_interval_v<T>;
+
+template <typename T>
+struct RealPart {
+    using type = T;
+};
+
+template <>
+struct RealPart<std::complex<long double>> {
+    using type = long double;
+};
+
+template <>
+struct RealPart<Complexes_t> {
+    using type = Reals_t;
+};
+
+template <typename T>
+struct RealPart<Interval<T>> {
+    using type = T;
+};
+
+template <Numeric _Domain>
+_Domain parse_number(const std::string& str) {
+    using Real = typename RealPart<_Domain>::type;
+    if constexpr (std::is_same_v<_Domain, DoubleDouble>) {
+        try {
+            return DoubleDouble::parse(str);
+        } catch (const std::runtime_error&) {
+            profile::count(profile::Counter::Exceptions);
+            throw;
+        }
+    } else if constexpr (std::is_floating_point_v<Real>) {
+        Real value{};
+        const char* end = str.data() + str.size();
+        auto [ptr, ec] = std::from_chars(str.data(), end, value);
+        if (ec != std::errc() || ptr != end) {
+            profile::count(profile::Counter::Exceptions);
+            throw std::runtime_error("Invalid number: " + str);
+        }
+        if constexpr (is_interval_v<_Domain>) {
+            if (str.find_first_not_of("0123456789") != std::string::npos) {
+                return _Domain::outward(value, value);
+            }
+        }
+        return _Domain(value);
+    } else {
+        return _Domain(std::stold(str));
+    }
+}
+
+template <Numeric _Domain>
+_Domain imaginary_unit() {
+    if constexpr (std::is_same_v<_Domain, Complexes_t> ||
+                  std::is_same_v<_Domain, std::complex<long double>>) {
+        return _Domain(0, 1);
+    } else {
+        return _Domain(0);
+    }
+}
+
+namespace detail {
+template <typename T>
+const T& math_value(const T& value) {
+    return value;
+}
+
+inline const std::complex<Reals_t>& math_value(const Complexes_t& value) {
+    return value;
+}
+
+template <typename T>
+T sin(const T& x) {
+    using std::sin;
+    return T(sin(math_value(x)));
+}
+
+template <typename T>
+T cos(const T& x) {
+    using std::cos;
+    return T(cos(math_value(x)));
+}
+
+template <typename T>
+T log(const T& x) {
+    using std::log;
+    return T(log(math_value(x)));
+}
+
+template <typename T>
+T exp(const T& x) {
+    using std::exp;
+    return T(exp(math_value(x)));
+}
+
+template <typename T>
+T pow(const T& x, const T& y) {
+    using std::pow;
+    return T(pow(math_value(x), math_value(y)));
+}
+
+template <typename T>
+bool outside_log_domain(const T& x) {
+    if constexpr (std::is_same_v<T, Complexes_t> ||
+                  std::is_same_v<T, std::complex<long double>>) {
+        return false;
+    } else if constexpr (is_interval_v<T>) {
+        return !(x.upper() > 0);
+    } else {
+        return x <= T(0);
+    }
+}
+};  // namespace detail
 
 template <Numeric _Domain>
 class Expression;
@@ -40,15 +166,27 @@ class Expression;
 template <Numeric _Domain = Reals_t>
 class ExpressionImpl {
    public:
-    ExpressionImpl() = default;
+    ExpressionImpl() { profile::count(profile::Counter::NodesCreated); }
     virtual ~ExpressionImpl() = default;
 
     virtual _Domain eval(const std::map<std::string, _Domain>&) const = 0;
     virtual Expression<_Domain> diff(const std::string&) const = 0;
+    virtual void collect_variables(std::set<std::string>&) const = 0;
+
+    virtual NodeKind kind() const = 0;
+    virtual const Expression<_Domain>& operand(size_t) const {
+        throw std::out_of_range("Expression node has no operands");
+    }
 
     virtual std::string to_string() const = 0;
 };
 
+template <Numeric _Domain>
+class Value;
+
+template <Numeric _Domain>
+class Variable;
+
 template <Numeric _Domain = Reals_t>
 class Expression {
     Expression(std::shared_ptr<ExpressionImpl<_Domain>> impl) : impl(impl) {}
@@ -111,19 +249,59 @@ class Expression {
     Expression ln() const;
     Expression exp() const;
 
-    std::string to_string() const { return impl ? impl->to_string() : "null"; }
+    std::string to_string() const {
+        allocation::Scope scope(allocation::Operation::ToString);
+        return impl ? impl->to_string() : "null";
+    }
 
     _Domain eval(const std::map<std::string, _Domain>& variables) const {
+        allocation::Scope scope(allocation::Operation::Eval);
+        profile::count(profile::Counter::Evaluations);
         return impl ? impl->eval(variables) : _Domain{};
     }
     Expression diff(const std::string& variable) const {
+        allocation::Scope scope(allocation::Operation::Diff);
         return impl ? impl->diff(variable) : _Domain{};
     }
 
+    void collect_variables(std::set<std::string>& result) const {
+        if (impl) {
+            impl->collect_variables(result);
+        }
+    }
+    std::set<std::string> variables() const {
+        std::set<std::string> result;
+        collect_variables(result);
+        return result;
+    }
+    std::vector<Expression> gradient(
+        const std::vector<std::string>& variables) const;
+
+    NodeKind kind() const { return node().kind(); }
+    size_t arity() const { return node_kind_arity(kind()); }
+    const Expression& operand(size_t index) const {
+        return node().operand(index);
+    }
+    _Domain value() const {
+        return dynamic_cast<const Value<_Domain>&>(node()).getValue();
+    }
+    const std::string& name() const {
+        return dynamic_cast<const Variable<_Domain>&>(node()).getName();
+    }
+    const void* id() const { return impl.get(); }
+
     friend std::ostream& operator<<(std::ostream& os, const Expression& ex) {
         os << ex.to_string();
         return os;
     }
+
+   private:
+    const ExpressionImpl<_Domain>& node() const {
+        if (!impl) {
+            throw std::logic_error("Null expression");
+        }
+        return *impl;
+    }
 };
 
 template <Numeric _Domain>
@@ -141,14 +319,18 @@ class Value : public ExpressionImpl<_Domain> {
         return _Domain{};
     };
 
+    virtual void collect_variables(std::set<std::string>&) const override {}
+
     virtual std::string to_string() const override {
-        if constexpr (std::is_same_v<_Domain, Complexes_t>) {
-            return symcpp::to_string(value);
+        if constexpr (std::is_arithmetic_v<_Domain>) {
+            return detail::format_number(value);
         } else {
-            return std::to_string(value);
+            return symcpp::to_string(value);
         }
     }
 
+    virtual NodeKind kind() const override { return NodeKind::Value; }
+
     _Domain getValue() const { return value; }
 
    private:
@@ -167,8 +349,9 @@ class Variable : public ExpressionImpl<_Domain> {
             return it->second;
         }
         if (variable == "i") {
-            return _Domain(Complexes_t(0, 1));
+            return imaginary_unit<_Domain>();
         }
+        profile::count(profile::Counter::Exceptions);
         throw std::runtime_error("Variable not found: " + variable);
     }
 
@@ -180,8 +363,17 @@ class Variable : public ExpressionImpl<_Domain> {
         return _Domain{};
     };
 
+    virtual void collect_variables(
+        std::set<std::string>& variables) const override {
+        variables.insert(variable);
+    }
+
+    virtual NodeKind kind() const override { return NodeKind::Variable; }
+
     virtual std::string to_string() const override { return variable; }
 
+    const std::string& getName() const { return variable; }
+
    private:
     std::string variable;
 };
@@ -202,10 +394,21 @@ class Add : public ExpressionImpl<_Domain> {
         return lhs.diff(variable) + rhs.diff(variable);
     };
 
+    virtual void collect_variables(
+        std::set<std::string>& variables) const override {
+        lhs.collect_variables(variables);
+        rhs.collect_variables(variables);
+    }
+
     virtual std::string to_string() const override {
         return "(" + lhs.to_string() + " + " + rhs.to_string() + ")";
     }
 
+    virtual NodeKind kind() const override { return NodeKind::Add; }
+    virtual const Expression<_Domain>& operand(size_t index) const override {
+        return index == 0 ? lhs : rhs;
+    }
+
    private:
     Expression<_Domain> lhs, rhs;
 };
@@ -226,10 +429,21 @@ class Subtract : public ExpressionImpl<_Domain> {
         return lhs.diff(variable) - rhs.diff(variable);
     };
 
+    virtual void collect_variables(
+        std::set<std::string>& variables) const override {
+        lhs.collect_variables(variables);
+        rhs.collect_variables(variables);
+    }
+
     virtual std::string to_string() const override {
         return "(" + lhs.to_string() + " - " + rhs.to_string() + ")";
     }
 
+    virtual NodeKind kind() const override { return NodeKind::Subtract; }
+    virtual const Expression<_Domain>& operand(size_t index) const override {
+        return index == 0 ? lhs : rhs;
+    }
+
    private:
     Expression<_Domain> lhs, rhs;
 };
@@ -250,10 +464,21 @@ class Multiply : public ExpressionImpl<_Domain> {
         return lhs.diff(variable) * rhs + lhs * rhs.diff(variable);
     };
 
+    virtual void collect_variables(
+        std::set<std::string>& variables) const override {
+        lhs.collect_variables(variables);
+        rhs.collect_variables(variables);
+    }
+
     virtual std::string to_string() const override {
         return "(" + lhs.to_string() + " * " + rhs.to_string() + ")";
     }
 
+    virtual NodeKind kind() const override { return NodeKind::Multiply; }
+    virtual const Expression<_Domain>& operand(size_t index) const override {
+        return index == 0 ? lhs : rhs;
+    }
+
    private:
     Expression<_Domain> lhs, rhs;
 };
@@ -268,6 +493,7 @@ class Divide : public ExpressionImpl<_Domain> {
         const std::map<std::string, _Domain>& variables) const override {
         _Domain divider = rhs.eval(variables);
         if (divider == _Domain(0.)) {
+            profile::count(profile::Counter::Exceptions);
             throw std::runtime_error("Division by zero");
         }
         return lhs.eval(variables) / divider;
@@ -279,10 +505,21 @@ class Divide : public ExpressionImpl<_Domain> {
                (rhs * rhs);
     };
 
+    virtual void collect_variables(
+        std::set<std::string>& variables) const override {
+        lhs.collect_variables(variables);
+        rhs.collect_variables(variables);
+    }
+
     virtual std::string to_string() const override {
         return "(" + lhs.to_string() + " / " + rhs.to_string() + ")";
     }
 
+    virtual NodeKind kind() const override { return NodeKind::Divide; }
+    virtual const Expression<_Domain>& operand(size_t index) const override {
+        return index == 0 ? lhs : rhs;
+    }
+
    private:
     Expression<_Domain> lhs, rhs;
 };
@@ -295,19 +532,34 @@ class Power : public ExpressionImpl<_Domain> {
 
     virtual _Domain eval(
         const std::map<std::string, _Domain>& variables) const override {
-        return std::pow(lhs.eval(variables), rhs.eval(variables));
+        return detail::pow(lhs.eval(variables), rhs.eval(variables));
     }
 
     virtual Expression<_Domain> diff(
         const std::string& variable) const override {
+        if (rhs.kind() == NodeKind::Value) {
+            return rhs * lhs.pow(rhs - Expression<_Domain>(1)) *
+                   lhs.diff(variable);
+        }
         return lhs.pow(rhs) *
                (rhs.diff(variable) * lhs.ln() + rhs * lhs.diff(variable) / lhs);
     };
 
+    virtual void collect_variables(
+        std::set<std::string>& variables) const override {
+        lhs.collect_variables(variables);
+        rhs.collect_variables(variables);
+    }
+
     virtual std::string to_string() const override {
         return "(" + lhs.to_string() + " ^ " + rhs.to_string() + ")";
     }
 
+    virtual NodeKind kind() const override { return NodeKind::Power; }
+    virtual const Expression<_Domain>& operand(size_t index) const override {
+        return index == 0 ? lhs : rhs;
+    }
+
    private:
     Expression<_Domain> lhs, rhs;
 };
@@ -319,7 +571,7 @@ class Sin : public ExpressionImpl<_Domain> {
 
     virtual _Domain eval(
         const std::map<std::string, _Domain>& variables) const override {
-        return _Domain(std::sin(expr.eval(variables)));
+        return detail::sin(expr.eval(variables));
     }
 
     virtual Expression<_Domain> diff(
@@ -327,10 +579,20 @@ class Sin : public ExpressionImpl<_Domain> {
         return expr.cos() * expr.diff(variable);
     };
 
+    virtual void collect_variables(
+        std::set<std::string>& variables) const override {
+        expr.collect_variables(variables);
+    }
+
     virtual std::string to_string() const override {
         return "sin(" + expr.to_string() + ")";
     }
 
+    virtual NodeKind kind() const override { return NodeKind::Sin; }
+    virtual const Expression<_Domain>& operand(size_t) const override {
+        return expr;
+    }
+
    private:
     Expression<_Domain> expr;
 };
@@ -342,7 +604,7 @@ class Cos : public ExpressionImpl<_Domain> {
 
     virtual _Domain eval(
         const std::map<std::string, _Domain>& variables) const override {
-        return _Domain(std::cos(expr.eval(variables)));
+        return detail::cos(expr.eval(variables));
     }
 
     virtual Expression<_Domain> diff(
@@ -350,10 +612,20 @@ class Cos : public ExpressionImpl<_Domain> {
         return Expression<_Domain>(-1) * expr.sin() * expr.diff(variable);
     };
 
+    virtual void collect_variables(
+        std::set<std::string>& variables) const override {
+        expr.collect_variables(variables);
+    }
+
     virtual std::string to_string() const override {
         return "cos(" + expr.to_string() + ")";
     }
 
+    virtual NodeKind kind() const override { return NodeKind::Cos; }
+    virtual const Expression<_Domain>& operand(size_t) const override {
+        return expr;
+    }
+
    private:
     Expression<_Domain> expr;
 };
@@ -366,13 +638,11 @@ class Ln : public ExpressionImpl<_Domain> {
     virtual _Domain eval(
         const std::map<std::string, _Domain>& variables) const override {
         _Domain phlogarithmic = expr.eval(variables);
-        if constexpr (std::is_same_v<_Domain, Complexes_t>) {
-        } else {
-            if (phlogarithmic <= _Domain(0)) {
-                throw std::runtime_error("Ln domain error");
-            }
+        if (detail::outside_log_domain(phlogarithmic)) {
+            profile::count(profile::Counter::Exceptions);
+            throw std::runtime_error("Ln domain error");
         }
-        return _Domain(std::log(expr.eval(variables)));
+        return detail::log(phlogarithmic);
     }
 
     virtual Expression<_Domain> diff(
@@ -380,10 +650,20 @@ class Ln : public ExpressionImpl<_Domain> {
         return Expression<_Domain>(1) / expr * expr.diff(variable);
     };
 
+    virtual void collect_variables(
+        std::set<std::string>& variables) const override {
+        expr.collect_variables(variables);
+    }
+
     virtual std::string to_string() const override {
         return "ln(" + expr.to_string() + ")";
     }
 
+    virtual NodeKind kind() const override { return NodeKind::Ln; }
+    virtual const Expression<_Domain>& operand(size_t) const override {
+        return expr;
+    }
+
    private:
     Expression<_Domain> expr;
 };
@@ -395,30 +675,48 @@ class Exp : public ExpressionImpl<_Domain> {
 
     virtual _Domain eval(
         const std::map<std::string, _Domain>& variables) const override {
-        return _Domain(std::exp(expr.eval(variables)));
+        return detail::exp(expr.eval(variables));
     }
 
     virtual Expression<_Domain> diff(
         const std::string& variable) const override {
-        return expr * expr.diff(variable);
+        return expr.exp() * expr.diff(variable);
     };
 
+    virtual void collect_variables(
+        std::set<std::string>& variables) const override {
+        expr.collect_variables(variables);
+    }
+
     virtual std::string to_string() const override {
         return "exp(" + expr.to_string() + ")";
     }
 
+    virtual NodeKind kind() const override { return NodeKind::Exp; }
+    virtual const Expression<_Domain>& operand(size_t) const override {
+        return expr;
+    }
+
    private:
     Expression<_Domain> expr;
 };
 
+template <typename _Node, typename... _Args>
+std::shared_ptr<_Node> make_node(NodeKind kind, _Args&&... args) {
+    allocation::Scope scope(allocation::Operation::Build);
+    allocation::KindScope kind_scope(kind);
+    return std::make_shared<_Node>(std::forward<_Args>(args)...);
+}
+
 template <Numeric _Domain>
 template <Numeric T>
 Expression<_Domain>::Expression(T value)
-    : impl(std::make_shared<Value<_Domain>>(static_cast<_Domain>(value))) {}
+    : impl(make_node<Value<_Domain>>(NodeKind::Value,
+                                      static_cast<_Domain>(value))) {}
 
 template <Numeric _Domain>
 Expression<_Domain>::Expression(const std::string& variable)
-    : impl(std::make_shared<Variable<_Domain>>(variable)) {}
+    : impl(make_node<Variable<_Domain>>(NodeKind::Variable, variable)) {}
 
 template <Numeric _Domain>
 Expression<_Domain> Expression<_Domain>::operator+(
@@ -426,16 +724,20 @@ Expression<_Domain> Expression<_Domain>::operator+(
     auto valueLhsPtr = std::dynamic_pointer_cast<Value<_Domain>>(this->impl);
     auto valueRhsPtr = std::dynamic_pointer_cast<Value<_Domain>>(other.impl);
     if (valueLhsPtr && valueRhsPtr) {
+        profile::count(profile::Counter::ConstantFolds);
         return Expression(valueLhsPtr->getValue() + valueRhsPtr->getValue());
     }
     if (valueLhsPtr && valueLhsPtr->getValue() == _Domain(0)) {
+        profile::count(profile::Counter::ConstantFolds);
         return other;
     }
     if (valueRhsPtr && valueRhsPtr->getValue() == _Domain(0)) {
+        profile::count(profile::Counter::ConstantFolds);
         return *this;
     }
 
-    return Expression(std::make_shared<Add<_Domain>>(*this, other));
+    return Expression(
+        make_node<Add<_Domain>>(NodeKind::Add, *this, other));
 }
 
 template <Numeric _Domain>
@@ -444,13 +746,16 @@ Expression<_Domain> Expression<_Domain>::operator-(
     auto valueLhsPtr = std::dynamic_pointer_cast<Value<_Domain>>(this->impl);
     auto valueRhsPtr = std::dynamic_pointer_cast<Value<_Domain>>(other.impl);
     if (valueLhsPtr && valueRhsPtr) {
+        profile::count(profile::Counter::ConstantFolds);
         return Expression(valueLhsPtr->getValue() - valueRhsPtr->getValue());
     }
     if (valueRhsPtr && valueRhsPtr->getValue() == _Domain(0)) {
+        profile::count(profile::Counter::ConstantFolds);
         return *this;
     }
 
-    return Expression(std::make_shared<Subtract<_Domain>>(*this, other));
+    return Expression(
+        make_node<Subtract<_Domain>>(NodeKind::Subtract, *this, other));
 }
 
 template <Numeric _Domain>
@@ -459,20 +764,25 @@ Expression<_Domain> Expression<_Domain>::operator*(
     auto valueLhsPtr = std::dynamic_pointer_cast<Value<_Domain>>(this->impl);
     auto valueRhsPtr = std::dynamic_pointer_cast<Value<_Domain>>(other.impl);
     if (valueLhsPtr && valueRhsPtr) {
+        profile::count(profile::Counter::ConstantFolds);
         return Expression(valueLhsPtr->getValue() * valueRhsPtr->getValue());
     }
     if (valueLhsPtr && valueLhsPtr->getValue() == _Domain(1)) {
+        profile::count(profile::Counter::ConstantFolds);
         return other;
     }
     if (valueRhsPtr && valueRhsPtr->getValue() == _Domain(1)) {
+        profile::count(profile::Counter::ConstantFolds);
         return *this;
     }
     if ((valueLhsPtr && valueLhsPtr->getValue() == _Domain(0)) ||
         (valueRhsPtr && valueRhsPtr->getValue() == _Domain(0))) {
+        profile::count(profile::Counter::ConstantFolds);
         return Expression<_Domain>(0);
     }
 
-    return Expression(std::make_shared<Multiply<_Domain>>(*this, other));
+    return Expression(
+        make_node<Multiply<_Domain>>(NodeKind::Multiply, *this, other));
 }
 
 template <Numeric _Domain>
@@ -481,19 +791,24 @@ Expression<_Domain> Expression<_Domain>::operator/(
     auto valueLhsPtr = std::dynamic_pointer_cast<Value<_Domain>>(this->impl);
     auto valueRhsPtr = std::dynamic_pointer_cast<Value<_Domain>>(other.impl);
     if (valueRhsPtr && valueRhsPtr->getValue() == _Domain(0)) {
+        profile::count(profile::Counter::Exceptions);
         throw std::runtime_error("Division by zero");
     }
     if (valueLhsPtr && valueRhsPtr) {
+        profile::count(profile::Counter::ConstantFolds);
         return Expression(valueLhsPtr->getValue() / valueRhsPtr->getValue());
     }
     if (valueRhsPtr && valueRhsPtr->getValue() == _Domain(1)) {
+        profile::count(profile::Counter::ConstantFolds);
         return *this;
     }
     if (valueLhsPtr && valueLhsPtr->getValue() == _Domain(0)) {
+        profile::count(profile::Counter::ConstantFolds);
         return Expression<_Domain>(0);
     }
 
-    return Expression(std::make_shared<Divide<_Domain>>(*this, other));
+    return Expression(
+        make_node<Divide<_Domain>>(NodeKind::Divide, *this, other));
 }
 
 template <Numeric _Domain>
@@ -502,53 +817,184 @@ Expression<_Domain> Expression<_Domain>::pow(
     auto valueLhsPtr = std::dynamic_pointer_cast<Value<_Domain>>(this->impl);
     auto valueRhsPtr = std::dynamic_pointer_cast<Value<_Domain>>(other.impl);
     if (valueLhsPtr && valueRhsPtr) {
+        profile::count(profile::Counter::ConstantFolds);
         return Expression(
-            std::pow(valueLhsPtr->getValue(), valueRhsPtr->getValue()));
+            detail::pow(valueLhsPtr->getValue(), valueRhsPtr->getValue()));
     }
     if (valueLhsPtr && valueLhsPtr->getValue() == _Domain(0)) {
+        profile::count(profile::Counter::ConstantFolds);
         return Expression<_Domain>(1);
     }
     if (valueRhsPtr && valueRhsPtr->getValue() == _Domain(1)) {
+        profile::count(profile::Counter::ConstantFolds);
         return *this;
     }
 
-    return Expression(std::make_shared<Power<_Domain>>(*this, other));
+    return Expression(
+        make_node<Power<_Domain>>(NodeKind::Power, *this, other));
 }
 
 template <Numeric _Domain>
 Expression<_Domain> Expression<_Domain>::sin() const {
     auto valuePtr = std::dynamic_pointer_cast<Value<_Domain>>(this->impl);
     if (valuePtr) {
-        return Expression(std::sin(valuePtr->getValue()));
+        profile::count(profile::Counter::ConstantFolds);
+        return Expression(detail::sin(valuePtr->getValue()));
     }
-    return Expression(std::make_shared<Sin<_Domain>>(*this));
+    return Expression(make_node<Sin<_Domain>>(NodeKind::Sin, *this));
 }
 
 template <Numeric _Domain>
 Expression<_Domain> Expression<_Domain>::cos() const {
     auto valuePtr = std::dynamic_pointer_cast<Value<_Domain>>(this->impl);
     if (valuePtr) {
-        return Expression(std::cos(valuePtr->getValue()));
+        profile::count(profile::Counter::ConstantFolds);
+        return Expression(detail::cos(valuePtr->getValue()));
     }
-    return Expression(std::make_shared<Cos<_Domain>>(*this));
+    return Expression(make_node<Cos<_Domain>>(NodeKind::Cos, *this));
 }
 
 template <Numeric _Domain>
 Expression<_Domain> Expression<_Domain>::ln() const {
     auto valuePtr = std::dynamic_pointer_cast<Value<_Domain>>(this->impl);
     if (valuePtr) {
-        return Expression(std::log(valuePtr->getValue()));
+        profile::count(profile::Counter::ConstantFolds);
+        return Expression(detail::log(valuePtr->getValue()));
     }
-    return Expression(std::make_shared<Ln<_Domain>>(*this));
+    return Expression(make_node<Ln<_Domain>>(NodeKind::Ln, *this));
 }
 
 template <Numeric _Domain>
 Expression<_Domain> Expression<_Domain>::exp() const {
     auto valuePtr = std::dynamic_pointer_cast<Value<_Domain>>(this->impl);
     if (valuePtr) {
-        return Expression(std::exp(valuePtr->getValue()));
+        profile::count(profile::Counter::ConstantFolds);
+        return Expression(detail::exp(valuePtr->getValue()));
+    }
+    return Expression(make_node<Exp<_Domain>>(NodeKind::Exp, *this));
+}
+
+template <Numeric _Domain>
+std::vector<Expression<_Domain>> Expression<_Domain>::gradient(
+    const std::vector<std::string>& variables) const {
+    allocation::Scope scope(allocation::Operation::Diff);
+    std::vector<Expression<_Domain>> result(variables.size(),
+                                            Expression<_Domain>(0));
+    if (!impl) {
+        return result;
+    }
+    std::set<std::string> wanted(variables.begin(), variables.end());
+    std::vector<Expression<_Domain>> nodes;
+    std::vector<uint32_t> operands;
+    std::vector<bool> active;
+    std::unordered_map<const void*, uint32_t> memo;
+    auto visit = [&](auto& self, const Expression<_Domain>& expr) -> uint32_t {
+        auto known = memo.find(expr.id());
+        if (known != memo.end()) {
+            return known->second;
+        }
+        uint32_t children[2] = {0, 0};
+        bool depends = expr.kind() == NodeKind::Variable &&
+                       wanted.count(expr.name()) > 0;
+        for (size_t i = 0; i < expr.arity(); ++i) {
+            children[i] = self(self, expr.operand(i));
+            depends = depends || active[children[i]];
+        }
+        nodes.push_back(expr);
+        operands.insert(operands.end(), children, children + 2);
+        active.push_back(depends);
+        uint32_t index = static_cast<uint32_t>(nodes.size() - 1);
+        memo.emplace(expr.id(), index);
+        return index;
+    };
+    visit(visit, *this);
+
+    std::vector<Expression<_Domain>> adjoints(nodes.size());
+    adjoints.back() = Expression<_Domain>(1);
+    auto add = [&](uint32_t index, auto term) {
+        if (!active[index]) {
+            return;
+        }
+        Expression<_Domain>& adjoint = adjoints[index];
+        adjoint = adjoint.impl ? adjoint + term() : term();
+    };
+    std::map<std::string, Expression<_Domain>> partials;
+    for (size_t k = nodes.size(); k-- > 0;) {
+        if (!active[k] || !adjoints[k].impl) {
+            continue;
+        }
+        const Expression<_Domain>& node = nodes[k];
+        const Expression<_Domain>& seed = adjoints[k];
+        uint32_t a = operands[2 * k], b = operands[2 * k + 1];
+        switch (node.kind()) {
+            case NodeKind::Value:
+                break;
+            case NodeKind::Variable: {
+                auto [partial, inserted] = partials.emplace(node.name(), seed);
+                if (!inserted) {
+                    partial->second = partial->second + seed;
+                }
+                break;
+            }
+            case NodeKind::Add:
+                add(a, [&] { return seed; });
+                add(b, [&] { return seed; });
+                break;
+            case NodeKind::Subtract:
+                add(a, [&] { return seed; });
+                add(b, [&] { return Expression<_Domain>(-1) * seed; });
+                break;
+            case NodeKind::Multiply:
+                add(a, [&] { return seed * node.operand(1); });
+                add(b, [&] { return node.operand(0) * seed; });
+                break;
+            case NodeKind::Divide:
+                add(a, [&] { return seed / node.operand(1); });
+                add(b, [&] {
+                    return Expression<_Domain>(-1) * seed * node /
+                           node.operand(1);
+                });
+                break;
+            case NodeKind::Power: {
+                const Expression<_Domain>& base = node.operand(0);
+                const Expression<_Domain>& power = node.operand(1);
+                if (power.kind() == NodeKind::Value) {
+                    add(a, [&] {
+                        return power *
+                               base.pow(power - Expression<_Domain>(1)) * seed;
+                    });
+                    break;
+                }
+                add(a, [&] { return seed * node * power / base; });
+                add(b, [&] { return seed * node * base.ln(); });
+                break;
+            }
+            case NodeKind::Sin:
+                add(a, [&] { return node.operand(0).cos() * seed; });
+                break;
+            case NodeKind::Cos:
+                add(a, [&] {
+                    return Expression<_Domain>(-1) * node.operand(0).sin() *
+                           seed;
+                });
+                break;
+            case NodeKind::Ln:
+                add(a, [&] {
+                    return Expression<_Domain>(1) / node.operand(0) * seed;
+                });
+                break;
+            case NodeKind::Exp:
+                add(a, [&] { return node * seed; });
+                break;
+        }
+    }
+    for (size_t i = 0; i < variables.size(); ++i) {
+        auto partial = partials.find(variables[i]);
+        if (partial != partials.end()) {
+            result[i] = partial->second;
+        }
     }
-    return Expression(std::make_shared<Exp<_Domain>>(*this));
+    return result;
 }
 
 template <typename T>
@@ -573,6 +1019,7 @@ auto exp(const T& expr) {
 
 template <Numeric _Domain = Reals_t>
 Expression<_Domain> parse_expression(const std::string& expr) {
+    allocation::Scope scope(allocation::Operation::Parse);
     std::stack<Expression<_Domain>> values;
     std::stack<char> ops;
 
@@ -607,7 +1054,7 @@ Expression<_Domain> parse_expression(const std::string& expr) {
                 num_str += expr[i++];
             }
             --i;
-            values.push(Expression<_Domain>(std::stold(num_str)));
+            values.push(Expression<_Domain>(parse_number<_Domain>(num_str)));
 
             expect_operand = false;
         } else if (std::isalpha(expr[i])) {
@@ -636,6 +1083,7 @@ Expression<_Domain> parse_expression(const std::string& expr) {
 
                     values.push(functions[token](arg));
                 } else {
+                    profile::count(profile::Counter::Exceptions);
                     throw std::runtime_error(
                         "Expected '(' after function name");
                 }
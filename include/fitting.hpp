@@ -0,0 +1,280 @@
+#ifndef FITTING_HPP
+#define FITTING_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "compiled.hpp"
+#include "dense.hpp"
+#include "expression.hpp"
+#include "parallel.hpp"
+#include "roots.hpp"
+
+namespace symcpp {
+struct FitOptions {
+    double tolerance = 1e-12;
+    double gradient_tolerance = 1e-10;
+    size_t max_iterations = 100;
+    size_t threads = 0;
+};
+
+template <typename _Domain>
+struct FitResult {
+    std::vector<_Domain> parameters;
+    _Domain cost{};
+    size_t iterations = 0;
+    size_t passes = 0;
+    RootStatus status = RootStatus::Failed;
+};
+
+template <typename _Domain = double>
+    requires std::is_floating_point_v<_Domain>
+class CurveFitter {
+   public:
+    static constexpr size_t block_size =
+        CompiledExpression<_Domain>::block_size;
+
+    CurveFitter(const Expression<_Domain>& model,
+                std::vector<std::string> parameters,
+                std::vector<std::string> columns, FitOptions options = {})
+        : parameter_names(std::move(parameters)),
+          column_names(std::move(columns)),
+          options(options),
+          model_kernel(model) {
+        std::vector<Expression<_Domain>> outputs{model};
+        for (const auto& derivative : model.gradient(parameter_names)) {
+            outputs.push_back(derivative);
+        }
+        jacobian_kernel = CompiledExpression<_Domain>(outputs);
+        std::vector<std::string> names = column_names;
+        model_slots = model_kernel.slots(parameter_names, names);
+        jacobian_slots = jacobian_kernel.slots(parameter_names, names);
+        if (names.size() != column_names.size()) {
+            throw std::runtime_error("Variable not found: " +
+                                     names[column_names.size()]);
+        }
+    }
+
+    FitResult<_Domain> fit(const std::vector<_Domain>& guess,
+                           const _Domain* const* columns,
+                           const _Domain* observed, size_t rows,
+                           const _Domain* weights = nullptr) const {
+        size_t p = parameter_names.size();
+        if (guess.size() != p) {
+            throw std::runtime_error("Initial parameters have wrong size");
+        }
+        Data data{columns, observed, weights, rows};
+        FitResult<_Domain> result;
+        result.parameters = guess;
+        Partial system;
+        std::vector<_Domain> damped, step(p), trial(p);
+        _Domain cost = accumulate(result.parameters, data, &system);
+        result.passes = 1;
+        _Domain lambda = 1e-3;
+        result.status = RootStatus::MaxIterations;
+        while (result.iterations < options.max_iterations) {
+            _Domain largest = 0;
+            for (size_t a = 0; a < p; ++a) {
+                largest = std::max(largest, std::fabs(system.gradient[a]));
+            }
+            if (largest <= options.gradient_tolerance) {
+                result.status = RootStatus::Converged;
+                break;
+            }
+            ++result.iterations;
+
+            bool accepted = false;
+            _Domain trial_cost = cost;
+            for (size_t attempt = 0; attempt < 30 && !accepted; ++attempt) {
+                damped = system.normal;
+                for (size_t a = 0; a < p; ++a) {
+                    _Domain& diagonal = damped[a * p + a];
+                    diagonal += lambda * std::max(diagonal, _Domain(1e-12));
+                    step[a] = -system.gradient[a];
+                }
+                if (cholesky_solve(damped, p, step.data())) {
+                    for (size_t a = 0; a < p; ++a) {
+                        trial[a] = result.parameters[a] + step[a];
+                    }
+                    try {
+                        trial_cost = accumulate(trial, data, nullptr);
+                    } catch (const std::runtime_error&) {
+                        trial_cost = std::numeric_limits<_Domain>::infinity();
+                    }
+                    ++result.passes;
+                    accepted = std::isfinite(trial_cost) && trial_cost < cost;
+                }
+                lambda = accepted ? std::max(lambda / 3, _Domain(1e-12))
+                                  : lambda * 4;
+            }
+            if (!accepted) {
+                result.status = cost <= options.tolerance * (1 + cost)
+                                    ? RootStatus::Converged
+                                    : RootStatus::Failed;
+                break;
+            }
+
+            _Domain change = cost - trial_cost;
+            result.parameters.swap(trial);
+            cost = accumulate(result.parameters, data, &system);
+            ++result.passes;
+            if (change <= options.tolerance * cost) {
+                result.status = RootStatus::Converged;
+                break;
+            }
+        }
+        result.cost = cost;
+        return result;
+    }
+
+   private:
+    struct Data {
+        const _Domain* const* columns;
+        const _Domain* observed;
+        const _Domain* weights;
+        size_t rows;
+    };
+
+    struct Partial {
+        _Domain cost = 0;
+        std::vector<_Domain> normal, gradient;
+    };
+
+    _Domain accumulate(const std::vector<_Domain>& parameters,
+                       const Data& data, Partial* system) const {
+        size_t p = parameter_names.size();
+        bool linearize = system != nullptr;
+        const auto& kernel = linearize ? jacobian_kernel : model_kernel;
+        const auto& slot = linearize ? jacobian_slots : model_slots;
+        size_t outputs = kernel.outputs().size();
+        size_t blocks = (data.rows + block_size - 1) / block_size;
+        size_t threads =
+            options.threads ? options.threads : default_threads();
+        threads = std::max<size_t>(1, std::min(threads, blocks));
+        std::vector<Partial> partial(threads);
+
+        parallel_for(
+            threads,
+            [&](size_t begin, size_t end) {
+                typename CompiledExpression<_Domain>::Workspace workspace;
+                std::vector<std::vector<_Domain>> constants(p);
+                std::vector<const _Domain*> pointers(slot.size());
+                std::vector<std::vector<_Domain>> values(
+                    outputs, std::vector<_Domain>(block_size));
+                std::vector<_Domain*> results(outputs);
+                for (size_t k = 0; k < outputs; ++k) {
+                    results[k] = values[k].data();
+                }
+                for (size_t a = 0; a < p; ++a) {
+                    constants[a].assign(block_size, parameters[a]);
+                }
+                for (size_t t = begin; t < end; ++t) {
+                    Partial& part = partial[t];
+                    if (linearize) {
+                        part.normal.assign(p * p, 0);
+                        part.gradient.assign(p, 0);
+                    }
+                    size_t first = blocks * t / threads;
+                    size_t last = blocks * (t + 1) / threads;
+                    for (size_t block = first; block < last; ++block) {
+                        size_t offset = block * block_size;
+                        size_t n = std::min(block_size, data.rows - offset);
+                        for (size_t v = 0; v < slot.size(); ++v) {
+                            pointers[v] =
+                                slot[v] < p
+                                    ? constants[slot[v]].data()
+                                    : data.columns[slot[v] - p] + offset;
+                        }
+                        kernel.eval_batch(pointers.data(), n, results.data(),
+                                          workspace);
+                        reduce(values, data, offset, n, linearize, part);
+                    }
+                }
+            },
+            threads);
+
+        _Domain cost = 0;
+        for (const auto& part : partial) {
+            cost += part.cost;
+        }
+        if (!system) {
+            return cost;
+        }
+        system->cost = cost;
+        system->normal.assign(p * p, 0);
+        system->gradient.assign(p, 0);
+        for (const auto& part : partial) {
+            for (size_t i = 0; i < p * p; ++i) {
+                system->normal[i] += part.normal[i];
+            }
+            for (size_t a = 0; a < p; ++a) {
+                system->gradient[a] += part.gradient[a];
+            }
+        }
+        for (size_t a = 0; a < p; ++a) {
+            for (size_t b = a + 1; b < p; ++b) {
+                system->normal[a * p + b] = system->normal[b * p + a];
+            }
+        }
+        return cost;
+    }
+
+    void reduce(std::vector<std::vector<_Domain>>& values, const Data& data,
+                size_t offset, size_t n, bool linearize,
+                Partial& part) const {
+        size_t p = parameter_names.size();
+        _Domain* residual = values[0].data();
+        const _Domain* observed = data.observed + offset;
+        const _Domain* weights = data.weights ? data.weights + offset : nullptr;
+        _Domain cost = 0;
+        for (size_t r = 0; r < n; ++r) {
+            residual[r] -= observed[r];
+            _Domain weight = weights ? weights[r] : _Domain(1);
+            cost += weight * residual[r] * residual[r];
+            residual[r] *= weight;
+        }
+        part.cost += cost;
+        if (!linearize) {
+            return;
+        }
+        for (size_t a = 0; a < p; ++a) {
+            const _Domain* ja = values[1 + a].data();
+            _Domain g = 0;
+            for (size_t r = 0; r < n; ++r) {
+                g += ja[r] * residual[r];
+            }
+            part.gradient[a] += g;
+            for (size_t b = 0; b <= a; ++b) {
+                const _Domain* jb = values[1 + b].data();
+                _Domain sum = 0;
+                if (weights) {
+                    for (size_t r = 0; r < n; ++r) {
+                        sum += ja[r] * weights[r] * jb[r];
+                    }
+                } else {
+                    for (size_t r = 0; r < n; ++r) {
+                        sum += ja[r] * jb[r];
+                    }
+                }
+                part.normal[a * p + b] += sum;
+            }
+        }
+    }
+
+    std::vector<std::string> parameter_names;
+    std::vector<std::string> column_names;
+    FitOptions options;
+    CompiledExpression<_Domain> model_kernel;
+    CompiledExpression<_Domain> jacobian_kernel;
+    std::vector<uint32_t> model_slots, jacobian_slots;
+};
+
+};  // namespace symcpp
+
+#endif  // FITTING_HPP
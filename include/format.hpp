@@ -0,0 +1,36 @@
+#ifndef FORMAT_HPP
+#define FORMAT_HPP
+
+#include <charconv>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+namespace symcpp {
+namespace detail {
+template <typename T>
+std::string format_number(T value) {
+    if constexpr (std::is_floating_point_v<T>) {
+        char buffer[64];
+        auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value,
+                                       std::chars_format::fixed);
+        if (ec == std::errc()) {
+            return std::string(buffer, end);
+        }
+        using limits = std::numeric_limits<T>;
+        std::string text(limits::max_exponent10 - limits::min_exponent10 +
+                             limits::max_digits10 + 8,
+                         '\0');
+        end = std::to_chars(text.data(), text.data() + text.size(), value,
+                            std::chars_format::fixed)
+                  .ptr;
+        text.resize(end - text.data());
+        return text;
+    } else {
+        return std::to_string(value);
+    }
+}
+};  // namespace detail
+};  // namespace symcpp
+
+#endif  // FORMAT_HPP
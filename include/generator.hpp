@@ -0,0 +1,374 @@
+#ifndef GENERATOR_HPP
+#define GENERATOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "expression.hpp"
+
+namespace symcpp {
+enum class Shape {
+    Random,
+    LongSum,
+    DeepNesting,
+    Polynomial,
+    TrigHeavy,
+};
+
+inline Shape shape_from_name(const std::string& name) {
+    if (name == "random") {
+        return Shape::Random;
+    }
+    if (name == "sum") {
+        return Shape::LongSum;
+    }
+    if (name == "nested") {
+        return Shape::DeepNesting;
+    }
+    if (name == "polynomial") {
+        return Shape::Polynomial;
+    }
+    if (name == "trig") {
+        return Shape::TrigHeavy;
+    }
+    throw std::runtime_error("Unknown shape: " + name);
+}
+
+struct GeneratorOptions {
+    size_t size = 64;
+    size_t max_depth = 64;
+    size_t variables = 4;
+    Shape shape = Shape::Random;
+    double sharing = 0;
+    double constants = 0.25;
+    bool safe = true;
+    std::array<double, node_kind_count> weights{0, 0, 4, 2, 4, 1,
+                                                1, 1, 1, 0.5, 0.5};
+};
+
+template <typename _Domain = double>
+class ExpressionGenerator {
+   public:
+    explicit ExpressionGenerator(GeneratorOptions options = {},
+                                 uint64_t seed = 0)
+        : options(options), rng(seed) {
+        if (options.variables == 0) {
+            throw std::runtime_error("Generator needs at least one variable");
+        }
+        for (size_t v = 0; variable_names.size() < options.variables; ++v) {
+            std::string name = variable_name(v);
+            if (name != "i" && name != "sin" && name != "cos" &&
+                name != "ln" && name != "exp") {
+                variable_names.push_back(name);
+            }
+        }
+    }
+
+    static std::string variable_name(size_t index) {
+        std::string result;
+        do {
+            result.insert(result.begin(), char('a' + index % 26));
+            index /= 26;
+        } while (index-- > 0);
+        return result;
+    }
+
+    const std::vector<std::string>& variables() const {
+        return variable_names;
+    }
+
+    std::string text() {
+        generate();
+        std::string result;
+        render(root, result);
+        return result;
+    }
+
+    Expression<_Domain> expression() {
+        generate();
+        std::vector<Expression<_Domain>> built(nodes.size());
+        std::vector<uint8_t> done(nodes.size(), 0);
+        return build(root, built, done);
+    }
+
+   private:
+    static const char* function_name(NodeKind kind) {
+        switch (kind) {
+            case NodeKind::Sin:
+                return "sin";
+            case NodeKind::Cos:
+                return "cos";
+            case NodeKind::Ln:
+                return "ln";
+            default:
+                return "exp";
+        }
+    }
+
+    struct Node {
+        NodeKind kind;
+        uint32_t lhs = 0;
+        uint32_t rhs = 0;
+        uint32_t leaf = 0;
+    };
+
+    size_t below(size_t n) { return n ? size_t(rng() % n) : 0; }
+    double chance() { return double(rng() >> 11) * 0x1.0p-53; }
+
+    uint32_t add(NodeKind kind, uint32_t lhs = 0, uint32_t rhs = 0,
+                 uint32_t leaf = 0) {
+        nodes.push_back({kind, lhs, rhs, leaf});
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+
+    uint32_t constant(uint32_t value) {
+        return add(NodeKind::Value, 0, 0, value);
+    }
+    uint32_t variable(size_t index) {
+        return add(NodeKind::Variable, 0, 0, static_cast<uint32_t>(index));
+    }
+    uint32_t leaf() {
+        if (chance() < options.constants) {
+            return constant(1 + static_cast<uint32_t>(below(9)));
+        }
+        return variable(below(variable_names.size()));
+    }
+
+    uint32_t apply(NodeKind kind, uint32_t lhs, uint32_t rhs = 0) {
+        if (!options.safe) {
+            return add(kind, lhs, rhs);
+        }
+        switch (kind) {
+            case NodeKind::Divide:
+                return add(kind, lhs,
+                           add(NodeKind::Add, constant(1),
+                               add(NodeKind::Power, rhs, constant(2))));
+            case NodeKind::Ln:
+                return add(kind, add(NodeKind::Add, constant(1),
+                                     add(NodeKind::Power, lhs, constant(2))));
+            case NodeKind::Exp:
+                return add(kind, add(NodeKind::Sin, lhs));
+            default:
+                return add(kind, lhs, rhs);
+        }
+    }
+
+    NodeKind pick(const std::array<double, node_kind_count>& weights) {
+        double total = 0;
+        for (double weight : weights) {
+            total += weight;
+        }
+        if (!(total > 0)) {
+            throw std::runtime_error("Operator weights are all zero");
+        }
+        double target = chance() * total;
+        for (size_t k = 0; k < node_kind_count; ++k) {
+            if (target < weights[k]) {
+                return static_cast<NodeKind>(k);
+            }
+            target -= weights[k];
+        }
+        return NodeKind::Add;
+    }
+
+    uint32_t random(size_t size, size_t depth,
+                    const std::array<double, node_kind_count>& weights) {
+        if (size == 0 || depth >= options.max_depth) {
+            return leaf();
+        }
+        if (!shared.empty() && chance() < options.sharing) {
+            return shared[below(shared.size())];
+        }
+        NodeKind kind = pick(weights);
+        uint32_t result;
+        switch (kind) {
+            case NodeKind::Value:
+            case NodeKind::Variable:
+                return leaf();
+            case NodeKind::Sin:
+            case NodeKind::Cos:
+            case NodeKind::Ln:
+            case NodeKind::Exp:
+                result = apply(kind, random(size - 1, depth + 1, weights));
+                break;
+            case NodeKind::Power: {
+                uint32_t base = random(size - 1, depth + 1, weights);
+                uint32_t exponent = 2 + static_cast<uint32_t>(below(2));
+                result = apply(kind, base, constant(exponent));
+                break;
+            }
+            default: {
+                size_t left = below(size);
+                uint32_t lhs = random(left, depth + 1, weights);
+                uint32_t rhs = random(size - 1 - left, depth + 1, weights);
+                result = apply(kind, lhs, rhs);
+            }
+        }
+        shared.push_back(result);
+        return result;
+    }
+
+    uint32_t term(size_t degree) {
+        uint32_t result = constant(1 + static_cast<uint32_t>(below(9)));
+        for (size_t d = 0; d < degree; ++d) {
+            result = add(NodeKind::Multiply, result,
+                         variable(below(variable_names.size())));
+        }
+        return result;
+    }
+
+    void generate() {
+        nodes.clear();
+        shared.clear();
+        size_t size = std::max<size_t>(options.size, 1);
+        switch (options.shape) {
+            case Shape::Random:
+                root = random(size, 0, options.weights);
+                break;
+            case Shape::TrigHeavy: {
+                auto weights = options.weights;
+                weights[size_t(NodeKind::Sin)] += 4;
+                weights[size_t(NodeKind::Cos)] += 4;
+                weights[size_t(NodeKind::Multiply)] += 2;
+                root = random(size, 0, weights);
+                break;
+            }
+            case Shape::LongSum:
+                root = term(1 + below(2));
+                for (size_t k = 1; k < size; ++k) {
+                    NodeKind kind = below(4) ? NodeKind::Add
+                                             : NodeKind::Subtract;
+                    root = add(kind, root, term(1 + below(2)));
+                }
+                break;
+            case Shape::Polynomial: {
+                size_t degree = std::clamp<size_t>(options.max_depth, 1, 6);
+                root = constant(1 + static_cast<uint32_t>(below(9)));
+                for (size_t k = 1; k < size; ++k) {
+                    root = add(NodeKind::Add, root, term(1 + below(degree)));
+                }
+                break;
+            }
+            case Shape::DeepNesting: {
+                size_t depth = std::min(size, options.max_depth);
+                root = leaf();
+                for (size_t k = 0; k < depth; ++k) {
+                    NodeKind kind = pick(options.weights);
+                    if (kind == NodeKind::Value ||
+                        kind == NodeKind::Variable) {
+                        kind = NodeKind::Add;
+                    }
+                    if (kind == NodeKind::Power) {
+                        root = apply(kind, root, constant(2));
+                    } else if (kind >= NodeKind::Sin) {
+                        root = apply(kind, root);
+                    } else {
+                        root = below(2) ? apply(kind, root, leaf())
+                                        : apply(kind, leaf(), root);
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    void render(uint32_t index, std::string& out) const {
+        const Node& node = nodes[index];
+        switch (node.kind) {
+            case NodeKind::Value:
+                out += std::to_string(node.leaf);
+                return;
+            case NodeKind::Variable:
+                out += variable_names[node.leaf];
+                return;
+            case NodeKind::Sin:
+            case NodeKind::Cos:
+            case NodeKind::Ln:
+            case NodeKind::Exp:
+                out += function_name(node.kind);
+                out += '(';
+                render(node.lhs, out);
+                out += ')';
+                return;
+            default:
+                break;
+        }
+        static constexpr char symbols[] = "  +-*/^";
+        out += '(';
+        render(node.lhs, out);
+        out += ' ';
+        out += symbols[size_t(node.kind)];
+        out += ' ';
+        render(node.rhs, out);
+        out += ')';
+    }
+
+    Expression<_Domain> build(uint32_t index,
+                              std::vector<Expression<_Domain>>& built,
+                              std::vector<uint8_t>& done) const {
+        if (done[index]) {
+            return built[index];
+        }
+        const Node& node = nodes[index];
+        Expression<_Domain> result;
+        switch (node.kind) {
+            case NodeKind::Value:
+                result = Expression<_Domain>(_Domain(node.leaf));
+                break;
+            case NodeKind::Variable:
+                result = Expression<_Domain>(variable_names[node.leaf]);
+                break;
+            case NodeKind::Add:
+                result = build(node.lhs, built, done) +
+                         build(node.rhs, built, done);
+                break;
+            case NodeKind::Subtract:
+                result = build(node.lhs, built, done) -
+                         build(node.rhs, built, done);
+                break;
+            case NodeKind::Multiply:
+                result = build(node.lhs, built, done) *
+                         build(node.rhs, built, done);
+                break;
+            case NodeKind::Divide:
+                result = build(node.lhs, built, done) /
+                         build(node.rhs, built, done);
+                break;
+            case NodeKind::Power:
+                result = build(node.lhs, built, done)
+                             .pow(build(node.rhs, built, done));
+                break;
+            case NodeKind::Sin:
+                result = build(node.lhs, built, done).sin();
+                break;
+            case NodeKind::Cos:
+                result = build(node.lhs, built, done).cos();
+                break;
+            case NodeKind::Ln:
+                result = build(node.lhs, built, done).ln();
+                break;
+            case NodeKind::Exp:
+                result = build(node.lhs, built, done).exp();
+                break;
+        }
+        built[index] = result;
+        done[index] = 1;
+        return result;
+    }
+
+    GeneratorOptions options;
+    std::mt19937_64 rng;
+    std::vector<std::string> variable_names;
+    std::vector<Node> nodes;
+    std::vector<uint32_t> shared;
+    uint32_t root = 0;
+};
+
+};  // namespace symcpp
+
+#endif  // GENERATOR_HPP
@@ -0,0 +1,371 @@
+#ifndef GLOBAL_HPP
+#define GLOBAL_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "compiled.hpp"
+#include "expression.hpp"
+#include "interval.hpp"
+#include "minimize.hpp"
+#include "parallel.hpp"
+
+namespace symcpp {
+namespace detail {
+template <Numeric _To, Numeric _From>
+Expression<_To> convert(
+    const Expression<_From>& expr,
+    std::unordered_map<const void*, Expression<_To>>& memo) {
+    auto known = memo.find(expr.id());
+    if (known != memo.end()) {
+        return known->second;
+    }
+    Expression<_To> result;
+    switch (expr.kind()) {
+        case NodeKind::Value:
+            result = Expression<_To>(_To(expr.value()));
+            break;
+        case NodeKind::Variable:
+            result = Expression<_To>(expr.name());
+            break;
+        case NodeKind::Add:
+            result = convert<_To>(expr.operand(0), memo) +
+                     convert<_To>(expr.operand(1), memo);
+            break;
+        case NodeKind::Subtract:
+            result = convert<_To>(expr.operand(0), memo) -
+                     convert<_To>(expr.operand(1), memo);
+            break;
+        case NodeKind::Multiply:
+            result = convert<_To>(expr.operand(0), memo) *
+                     convert<_To>(expr.operand(1), memo);
+            break;
+        case NodeKind::Divide:
+            result = convert<_To>(expr.operand(0), memo) /
+                     convert<_To>(expr.operand(1), memo);
+            break;
+        case NodeKind::Power:
+            result = convert<_To>(expr.operand(0), memo)
+                         .pow(convert<_To>(expr.operand(1), memo));
+            break;
+        case NodeKind::Sin:
+            result = convert<_To>(expr.operand(0), memo).sin();
+            break;
+        case NodeKind::Cos:
+            result = convert<_To>(expr.operand(0), memo).cos();
+            break;
+        case NodeKind::Ln:
+            result = convert<_To>(expr.operand(0), memo).ln();
+            break;
+        case NodeKind::Exp:
+            result = convert<_To>(expr.operand(0), memo).exp();
+            break;
+    }
+    memo.emplace(expr.id(), result);
+    return result;
+}
+};  // namespace detail
+
+struct GlobalOptions {
+    double tolerance = 1e-8;
+    double box_width = 1e-10;
+    size_t max_boxes = 1000000;
+    size_t batch = 256;
+    size_t local_searches = 16;
+    size_t threads = 0;
+};
+
+template <typename _Domain>
+struct GlobalMinimum {
+    std::vector<_Domain> x;
+    _Domain value = std::numeric_limits<_Domain>::infinity();
+    _Domain lower_bound = -std::numeric_limits<_Domain>::infinity();
+    size_t boxes = 0;
+    size_t local_searches = 0;
+    bool converged = false;
+};
+
+template <typename _Domain = double>
+    requires std::is_floating_point_v<_Domain>
+class GlobalMinimizer {
+   public:
+    using Range = Interval<_Domain>;
+
+    GlobalMinimizer(const Expression<_Domain>& objective,
+                    std::vector<std::string> variables,
+                    GlobalOptions options = {})
+        : variable_names(std::move(variables)),
+          options(options),
+          point_kernel(objective),
+          local(objective, variable_names) {
+        std::unordered_map<const void*, Expression<Range>> memo;
+        Expression<Range> enclosure = detail::convert<Range>(objective, memo);
+        std::vector<Expression<Range>> outputs{enclosure};
+        for (const auto& derivative : enclosure.gradient(variable_names)) {
+            outputs.push_back(derivative);
+        }
+        range_kernel = CompiledExpression<Range>(outputs);
+        parameter_names = local.parameters();
+        point_slots = point_kernel.slots(variable_names, parameter_names);
+        range_slots = range_kernel.slots(variable_names, parameter_names);
+    }
+
+    const std::vector<std::string>& parameters() const {
+        return parameter_names;
+    }
+
+    GlobalMinimum<_Domain> minimize(
+        const std::vector<_Domain>& lower, const std::vector<_Domain>& upper,
+        const std::map<std::string, _Domain>& values = {}) const {
+        size_t n = variable_names.size();
+        if (lower.size() != n || upper.size() != n) {
+            throw std::runtime_error("Search box has wrong size");
+        }
+        std::vector<_Domain> fixed;
+        for (const auto& name : parameter_names) {
+            auto it = values.find(name);
+            if (it == values.end()) {
+                throw std::runtime_error("Variable not found: " + name);
+            }
+            fixed.push_back(it->second);
+        }
+
+        Search search(lower, upper, std::move(fixed), values);
+        search.storage.resize(n);
+        for (size_t v = 0; v < n; ++v) {
+            search.storage[v] = Range(lower[v], upper[v]);
+        }
+        search.children = search.storage;
+        evaluate(1, search);
+        GlobalMinimum<_Domain> result;
+        _Domain final_bound = std::numeric_limits<_Domain>::infinity();
+        if (consider(0, search, result) && options.local_searches > 0) {
+            refine(search, result);
+        }
+        search.storage.clear();
+        admit(0, search, result, final_bound);
+
+        while (!search.queue.empty() && result.boxes < options.max_boxes) {
+            search.children.clear();
+            size_t taken = 0;
+            while (!search.queue.empty() && taken < options.batch) {
+                auto [bound, slot] = search.queue.top();
+                search.queue.pop();
+                if (bound > result.value - options.tolerance) {
+                    search.free.push_back(slot);
+                    continue;
+                }
+                split(slot, search);
+                search.free.push_back(slot);
+                ++taken;
+            }
+            size_t count = search.children.size() / n;
+            if (count == 0) {
+                break;
+            }
+            result.boxes += count;
+            evaluate(count, search);
+            bool improved = false;
+            for (size_t c = 0; c < count; ++c) {
+                improved |= consider(c, search, result);
+            }
+            if (improved && result.local_searches < options.local_searches) {
+                refine(search, result);
+            }
+            for (size_t c = 0; c < count; ++c) {
+                admit(c, search, result, final_bound);
+            }
+        }
+
+        result.converged = search.queue.empty();
+        result.lower_bound =
+            std::min(final_bound, result.value - _Domain(options.tolerance));
+        if (!search.queue.empty()) {
+            result.lower_bound =
+                std::min(result.lower_bound, search.queue.top().first);
+        }
+        return result;
+    }
+
+   private:
+    using Entry = std::pair<_Domain, uint32_t>;
+
+    struct Search {
+        Search(const std::vector<_Domain>& lower,
+               const std::vector<_Domain>& upper, std::vector<_Domain> fixed,
+               const std::map<std::string, _Domain>& values)
+            : lower(lower), upper(upper), fixed(std::move(fixed)),
+              values(values) {}
+
+        std::vector<_Domain> lower, upper, fixed;
+        std::map<std::string, _Domain> values;
+        std::vector<Range> storage, children, ranges;
+        std::vector<_Domain> middles;
+        std::vector<uint8_t> valid;
+        std::vector<uint32_t> free;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>>
+            queue;
+    };
+
+    void split(uint32_t slot, Search& search) const {
+        size_t n = variable_names.size();
+        const Range* box = search.storage.data() + size_t(slot) * n;
+        size_t widest = 0;
+        _Domain best = -1;
+        for (size_t v = 0; v < n; ++v) {
+            _Domain scale = search.upper[v] - search.lower[v];
+            _Domain width = box[v].width() / (scale > 0 ? scale : 1);
+            if (width > best) {
+                best = width;
+                widest = v;
+            }
+        }
+        _Domain middle = box[widest].mid();
+        for (size_t half = 0; half < 2; ++half) {
+            size_t offset = search.children.size();
+            search.children.insert(search.children.end(), box, box + n);
+            Range& side = search.children[offset + widest];
+            side = half == 0 ? Range(side.lower(), middle)
+                             : Range(middle, side.upper());
+        }
+    }
+
+    void evaluate(size_t count, Search& search) const {
+        size_t n = variable_names.size();
+        size_t outputs = n + 1;
+        size_t block_size = CompiledExpression<Range>::block_size;
+        search.ranges.resize(count * outputs);
+        search.middles.resize(count);
+        search.valid.resize(count);
+        size_t blocks = (count + block_size - 1) / block_size;
+        parallel_for(
+            blocks,
+            [&](size_t begin, size_t end) {
+                typename CompiledExpression<Range>::Workspace ranges;
+                typename CompiledExpression<_Domain>::Workspace points;
+                std::vector<Range> range_inputs(range_slots.size());
+                std::vector<_Domain> point_inputs(point_slots.size());
+                for (size_t c = begin * block_size;
+                     c < std::min(end * block_size, count); ++c) {
+                    const Range* box = search.children.data() + c * n;
+                    for (size_t v = 0; v < range_slots.size(); ++v) {
+                        uint32_t s = range_slots[v];
+                        range_inputs[v] =
+                            s < n ? box[s] : Range(search.fixed[s - n]);
+                    }
+                    for (size_t v = 0; v < point_slots.size(); ++v) {
+                        uint32_t s = point_slots[v];
+                        point_inputs[v] =
+                            s < n ? box[s].mid() : search.fixed[s - n];
+                    }
+                    try {
+                        range_kernel.eval(range_inputs.data(),
+                                          search.ranges.data() + c * outputs,
+                                          ranges);
+                        search.valid[c] =
+                            !search.ranges[c * outputs].is_empty();
+                    } catch (const std::runtime_error&) {
+                        search.valid[c] = 0;
+                    }
+                    try {
+                        point_kernel.eval(point_inputs.data(),
+                                          &search.middles[c], points);
+                    } catch (const std::runtime_error&) {
+                        search.middles[c] =
+                            std::numeric_limits<_Domain>::quiet_NaN();
+                    }
+                }
+            },
+            options.threads);
+    }
+
+    bool consider(size_t c, const Search& search,
+                  GlobalMinimum<_Domain>& result) const {
+        size_t n = variable_names.size();
+        _Domain value = search.middles[c];
+        if (!search.valid[c] || !std::isfinite(value) ||
+            !(value < result.value)) {
+            return false;
+        }
+        result.value = value;
+        result.x.resize(n);
+        for (size_t v = 0; v < n; ++v) {
+            result.x[v] = search.children[c * n + v].mid();
+        }
+        return true;
+    }
+
+    void refine(const Search& search, GlobalMinimum<_Domain>& result) const {
+        ++result.local_searches;
+        Minimum<_Domain> local_minimum = local.minimize(
+            result.x, search.lower, search.upper, search.values);
+        if (std::isfinite(local_minimum.value) &&
+            local_minimum.value < result.value &&
+            local_minimum.status != RootStatus::Failed) {
+            result.value = local_minimum.value;
+            result.x = local_minimum.x;
+        }
+    }
+
+    void admit(size_t c, Search& search, const GlobalMinimum<_Domain>& result,
+               _Domain& final_bound) const {
+        size_t n = variable_names.size();
+        size_t outputs = n + 1;
+        if (!search.valid[c]) {
+            return;
+        }
+        const Range* box = search.children.data() + c * n;
+        const Range* ranges = search.ranges.data() + c * outputs;
+        _Domain bound = ranges[0].lower();
+        if (bound > result.value - options.tolerance) {
+            return;
+        }
+        _Domain width = 0;
+        for (size_t v = 0; v < n; ++v) {
+            const Range& slope = ranges[1 + v];
+            if ((slope.lower() > 0 && box[v].lower() > search.lower[v]) ||
+                (slope.upper() < 0 && box[v].upper() < search.upper[v])) {
+                return;
+            }
+            width = std::max(width, box[v].width());
+        }
+        if (width <= options.box_width) {
+            final_bound = std::min(final_bound, bound);
+            return;
+        }
+
+        uint32_t slot;
+        if (search.free.empty()) {
+            slot = static_cast<uint32_t>(search.storage.size() / n);
+            search.storage.resize(search.storage.size() + n);
+        } else {
+            slot = search.free.back();
+            search.free.pop_back();
+        }
+        std::copy_n(box, n, search.storage.begin() + size_t(slot) * n);
+        search.queue.emplace(bound, slot);
+    }
+
+    std::vector<std::string> variable_names;
+    std::vector<std::string> parameter_names;
+    GlobalOptions options;
+    CompiledExpression<_Domain> point_kernel;
+    CompiledExpression<Range> range_kernel;
+    Minimizer<_Domain> local;
+    std::vector<uint32_t> point_slots, range_slots;
+};
+
+};  // namespace symcpp
+
+#endif  // GLOBAL_HPP
@@ -0,0 +1,266 @@
+#ifndef INTERVAL_HPP
+#define INTERVAL_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+#include "format.hpp"
+
+namespace symcpp {
+template <typename T>
+class Interval {
+    static_assert(std::is_floating_point_v<T>);
+
+    static constexpr T infinity = std::numeric_limits<T>::infinity();
+    static constexpr T nan = std::numeric_limits<T>::quiet_NaN();
+    static constexpr T pi = std::numbers::pi_v<T>;
+
+   public:
+    using value_type = T;
+
+    Interval() = default;
+    template <typename U>
+        requires std::is_arithmetic_v<U>
+    Interval(U value) : lo(static_cast<T>(value)), hi(static_cast<T>(value)) {}
+    Interval(T lower, T upper) : lo(lower), hi(upper) {}
+
+    static Interval entire() { return Interval(-infinity, infinity); }
+    static Interval empty() { return Interval(nan, nan); }
+    static Interval outward(T lower, T upper) {
+        return Interval(std::nextafter(lower, -infinity),
+                        std::nextafter(upper, infinity));
+    }
+
+    T lower() const { return lo; }
+    T upper() const { return hi; }
+    T mid() const { return lo / 2 + hi / 2; }
+    T width() const { return hi - lo; }
+    bool is_empty() const { return std::isnan(lo) || std::isnan(hi); }
+    bool contains(T value) const { return lo <= value && value <= hi; }
+
+    friend bool operator==(const Interval& lhs, const Interval& rhs) {
+        return lhs.lo == rhs.lo && lhs.hi == rhs.hi;
+    }
+
+    friend Interval operator-(const Interval& x) {
+        return Interval(-x.hi, -x.lo);
+    }
+
+    friend Interval operator+(const Interval& lhs, const Interval& rhs) {
+        T lower = lhs.lo + rhs.lo;
+        T upper = lhs.hi + rhs.hi;
+        return Interval(down(lower, sum_error(lhs.lo, rhs.lo, lower)),
+                        up(upper, sum_error(lhs.hi, rhs.hi, upper)));
+    }
+
+    friend Interval operator-(const Interval& lhs, const Interval& rhs) {
+        return lhs + -rhs;
+    }
+
+    friend Interval operator*(const Interval& lhs, const Interval& rhs) {
+        if (lhs.is_empty() || rhs.is_empty()) {
+            return empty();
+        }
+        return hull(product(lhs.lo, rhs.lo), product(lhs.lo, rhs.hi),
+                    product(lhs.hi, rhs.lo), product(lhs.hi, rhs.hi));
+    }
+
+    friend Interval operator/(const Interval& lhs, const Interval& rhs) {
+        if (lhs.is_empty() || rhs.is_empty()) {
+            return empty();
+        }
+        if (rhs.lo > 0 || rhs.hi < 0) {
+            return hull(quotient(lhs.lo, rhs.lo), quotient(lhs.lo, rhs.hi),
+                        quotient(lhs.hi, rhs.lo), quotient(lhs.hi, rhs.hi));
+        }
+        if (lhs.contains(0) || (rhs.lo < 0) == (rhs.hi > 0)) {
+            return entire();
+        }
+        if (rhs.lo == 0) {
+            return lhs.lo > 0
+                       ? Interval(quotient(lhs.lo, rhs.hi).lo, infinity)
+                       : Interval(-infinity, quotient(lhs.hi, rhs.hi).hi);
+        }
+        return lhs.lo > 0 ? Interval(-infinity, quotient(lhs.lo, rhs.lo).hi)
+                          : Interval(quotient(lhs.hi, rhs.lo).lo, infinity);
+    }
+
+    Interval& operator+=(const Interval& other) {
+        return *this = *this + other;
+    }
+    Interval& operator-=(const Interval& other) {
+        return *this = *this - other;
+    }
+    Interval& operator*=(const Interval& other) {
+        return *this = *this * other;
+    }
+    Interval& operator/=(const Interval& other) {
+        return *this = *this / other;
+    }
+
+    friend Interval exp(const Interval& x) {
+        Interval result = outward(std::exp(x.lo), std::exp(x.hi));
+        result.lo = std::max(result.lo, T(0));
+        return result;
+    }
+
+    friend Interval log(const Interval& x) {
+        if (!(x.hi > 0)) {
+            return empty();
+        }
+        if (x.lo <= 0) {
+            return outward(-infinity, std::log(x.hi));
+        }
+        return outward(std::log(x.lo), std::log(x.hi));
+    }
+
+    friend Interval sin(const Interval& x) {
+        return periodic(x, std::sin(x.lo), std::sin(x.hi), pi / 2);
+    }
+
+    friend Interval cos(const Interval& x) {
+        return periodic(x, std::cos(x.lo), std::cos(x.hi), 0);
+    }
+
+    friend Interval pow(const Interval& x, const Interval& y) {
+        if (x.is_empty() || y.is_empty()) {
+            return empty();
+        }
+        if (y.lo == y.hi && y.lo == std::trunc(y.lo) &&
+            std::fabs(y.lo) < T(1) / std::numeric_limits<T>::epsilon()) {
+            return integer_power(x, y.lo);
+        }
+        if (x.hi < 0) {
+            return empty();
+        }
+        return exp(y * log(Interval(std::max(x.lo, T(0)), x.hi)));
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const Interval& x) {
+        return os << '[' << x.lo << ", " << x.hi << ']';
+    }
+
+   private:
+    static T down(T value, T error) {
+        return error < 0 ? std::nextafter(value, -infinity) : value;
+    }
+
+    static T up(T value, T error) {
+        return error > 0 ? std::nextafter(value, infinity) : value;
+    }
+
+    static T sum_error(T a, T b, T sum) {
+        if (!std::isfinite(sum)) {
+            return std::isfinite(a) && std::isfinite(b) ? -sum : T(0);
+        }
+        T b_virtual = sum - a;
+        return (a - (sum - b_virtual)) + (b - b_virtual);
+    }
+
+    static Interval rounded(T value, T error, bool nonzero) {
+        if (nonzero && std::fabs(value) < std::numeric_limits<T>::min()) {
+            return outward(value, value);
+        }
+        return Interval(down(value, error), up(value, error));
+    }
+
+    static Interval product(T a, T b) {
+        if (a == 0 || b == 0) {
+            return Interval(0);
+        }
+        T p = a * b;
+        return rounded(p, std::fma(a, b, -p), true);
+    }
+
+    static Interval quotient(T a, T b) {
+        T q = a / b;
+        T remainder = std::fma(-q, b, a);
+        return rounded(q, b > 0 ? remainder : -remainder, a != 0);
+    }
+
+    static Interval hull(const Interval& a, const Interval& b,
+                         const Interval& c, const Interval& d) {
+        return Interval(std::min({a.lo, b.lo, c.lo, d.lo}),
+                        std::max({a.hi, b.hi, c.hi, d.hi}));
+    }
+
+    static Interval integer_power(const Interval& x, T n) {
+        if (n == 0) {
+            return Interval(1);
+        }
+        if (n < 0) {
+            return Interval(1) / integer_power(x, -n);
+        }
+        T lower = std::pow(x.lo, n);
+        T upper = std::pow(x.hi, n);
+        if (std::fmod(n, T(2)) != 0 || x.lo >= 0) {
+            return outward(lower, upper);
+        }
+        if (x.hi <= 0) {
+            return outward(upper, lower);
+        }
+        return Interval(0, std::nextafter(std::max(lower, upper), infinity));
+    }
+
+    static bool hits_phase(const Interval& x, T phase, T slack) {
+        T k = std::ceil((x.lo - phase) / (2 * pi));
+        for (T j : {k - 1, k}) {
+            T point = phase + 2 * pi * j;
+            if (point >= x.lo - slack && point <= x.hi + slack) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static Interval periodic(const Interval& x, T at_lower, T at_upper,
+                             T peak) {
+        if (x.is_empty()) {
+            return empty();
+        }
+        if (!std::isfinite(x.lo) || !std::isfinite(x.hi) ||
+            x.width() >= 2 * pi) {
+            return Interval(-1, 1);
+        }
+        Interval result = outward(std::min(at_lower, at_upper),
+                                  std::max(at_lower, at_upper));
+        T slack = 4 * std::numeric_limits<T>::epsilon() *
+                  (std::fabs(x.lo) + std::fabs(x.hi) + 1);
+        if (hits_phase(x, peak, slack)) {
+            result.hi = 1;
+        }
+        if (hits_phase(x, peak + pi, slack)) {
+            result.lo = -1;
+        }
+        result.lo = std::max(result.lo, T(-1));
+        result.hi = std::min(result.hi, T(1));
+        return result;
+    }
+
+    T lo = 0;
+    T hi = 0;
+};
+
+template <typename T>
+struct is_interval : std::false_type {};
+
+template <typename T>
+struct is_interval<Interval<T>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool is_interval_v = is_interval<T>::value;
+
+template <typename T>
+std::string to_string(const Interval<T>& x) {
+    return "[" + detail::format_number(x.lower()) + ", " +
+           detail::format_number(x.upper()) + "]";
+}
+
+};  // namespace symcpp
+
+#endif  // INTERVAL_HPP
@@ -0,0 +1,308 @@
+#ifndef MINIMIZE_HPP
+#define MINIMIZE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "compiled.hpp"
+#include "expression.hpp"
+#include "roots.hpp"
+
+namespace symcpp {
+struct MinimizerOptions {
+    size_t history = 8;
+    double gradient_tolerance = 1e-8;
+    double value_tolerance = 1e-15;
+    size_t max_iterations = 500;
+    size_t max_line_search = 40;
+};
+
+template <typename _Domain>
+struct Minimum {
+    std::vector<_Domain> x;
+    _Domain value{};
+    _Domain gradient_norm{};
+    size_t iterations = 0;
+    size_t evaluations = 0;
+    RootStatus status = RootStatus::Failed;
+};
+
+template <typename _Domain = Reals_t>
+    requires std::is_floating_point_v<_Domain>
+class Minimizer {
+   public:
+    struct Workspace {
+        std::vector<_Domain> point, inputs, outputs;
+        std::vector<_Domain> lower, upper;
+        std::vector<_Domain> x, gradient, trial, trial_gradient, direction;
+        std::vector<_Domain> step, change;
+        std::vector<_Domain> s, y, rho, alpha;
+        typename CompiledExpression<_Domain>::Workspace kernel;
+    };
+
+    Minimizer(const Expression<_Domain>& objective,
+              std::vector<std::string> variables,
+              MinimizerOptions options = {})
+        : variable_names(std::move(variables)), options(options) {
+        std::vector<Expression<_Domain>> outputs{objective};
+        for (const auto& derivative : objective.gradient(variable_names)) {
+            outputs.push_back(derivative);
+        }
+        kernel = CompiledExpression<_Domain>(outputs);
+        slots = kernel.slots(variable_names, parameter_names);
+        this->options.history = std::max(options.history, size_t(1));
+    }
+
+    const std::vector<std::string>& parameters() const {
+        return parameter_names;
+    }
+
+    Minimum<_Domain> minimize(
+        const std::vector<_Domain>& guess,
+        const std::vector<_Domain>& lower = {},
+        const std::vector<_Domain>& upper = {},
+        const std::map<std::string, _Domain>& values = {},
+        Workspace* workspace = nullptr) const {
+        size_t n = variable_names.size();
+        if (guess.size() != n || (!lower.empty() && lower.size() != n) ||
+            (!upper.empty() && upper.size() != n)) {
+            throw std::runtime_error("Minimizer arguments have wrong size");
+        }
+        Workspace local;
+        Workspace& w = workspace ? *workspace : local;
+        prepare(w, values);
+        w.lower = lower;
+        w.upper = upper;
+        w.lower.resize(n, -std::numeric_limits<_Domain>::infinity());
+        w.upper.resize(n, std::numeric_limits<_Domain>::infinity());
+        for (size_t i = 0; i < n; ++i) {
+            w.x[i] = std::clamp(guess[i], w.lower[i], w.upper[i]);
+        }
+        return run(w);
+    }
+
+   private:
+    void prepare(Workspace& w,
+                 const std::map<std::string, _Domain>& values) const {
+        size_t n = variable_names.size();
+        size_t m = options.history;
+        w.point.assign(n, _Domain(0));
+        for (const auto& name : parameter_names) {
+            auto it = values.find(name);
+            if (it == values.end()) {
+                throw std::runtime_error("Variable not found: " + name);
+            }
+            w.point.push_back(it->second);
+        }
+        w.inputs.resize(slots.size());
+        w.outputs.resize(n + 1);
+        for (auto* v : {&w.x, &w.gradient, &w.trial, &w.trial_gradient,
+                        &w.direction, &w.step, &w.change}) {
+            v->resize(n);
+        }
+        w.s.resize(m * n);
+        w.y.resize(m * n);
+        w.rho.resize(m);
+        w.alpha.resize(m);
+    }
+
+    bool evaluate(const std::vector<_Domain>& x, _Domain& value,
+                  std::vector<_Domain>& gradient, Workspace& w) const {
+        size_t n = variable_names.size();
+        std::copy_n(x.begin(), n, w.point.begin());
+        for (size_t v = 0; v < slots.size(); ++v) {
+            w.inputs[v] = w.point[slots[v]];
+        }
+        try {
+            kernel.eval(w.inputs.data(), w.outputs.data(), w.kernel);
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+        value = w.outputs[0];
+        std::copy_n(w.outputs.begin() + 1, n, gradient.begin());
+        return std::isfinite(value);
+    }
+
+    bool fixed(size_t i, const Workspace& w) const {
+        return (w.x[i] <= w.lower[i] && w.gradient[i] > 0) ||
+               (w.x[i] >= w.upper[i] && w.gradient[i] < 0);
+    }
+
+    _Domain projected_gradient_norm(const Workspace& w) const {
+        using std::fabs;
+        _Domain norm = 0;
+        for (size_t i = 0; i < variable_names.size(); ++i) {
+            if (!fixed(i, w)) {
+                norm = std::max(norm, fabs(w.gradient[i]));
+            }
+        }
+        return norm;
+    }
+
+    void direction(size_t stored, size_t newest, Workspace& w) const {
+        size_t n = variable_names.size();
+        size_t m = options.history;
+        _Domain* q = w.direction.data();
+        for (size_t i = 0; i < n; ++i) {
+            q[i] = fixed(i, w) ? 0 : w.gradient[i];
+        }
+        for (size_t k = 0; k < stored; ++k) {
+            size_t slot = (newest + m - k) % m;
+            const _Domain* s = w.s.data() + slot * n;
+            const _Domain* y = w.y.data() + slot * n;
+            _Domain dot = 0;
+            for (size_t i = 0; i < n; ++i) {
+                dot += s[i] * q[i];
+            }
+            w.alpha[slot] = w.rho[slot] * dot;
+            for (size_t i = 0; i < n; ++i) {
+                q[i] -= w.alpha[slot] * y[i];
+            }
+        }
+        if (stored > 0) {
+            const _Domain* s = w.s.data() + newest * n;
+            const _Domain* y = w.y.data() + newest * n;
+            _Domain sy = 0;
+            _Domain yy = 0;
+            for (size_t i = 0; i < n; ++i) {
+                sy += s[i] * y[i];
+                yy += y[i] * y[i];
+            }
+            for (size_t i = 0; i < n; ++i) {
+                q[i] *= sy / yy;
+            }
+        }
+        for (size_t k = stored; k-- > 0;) {
+            size_t slot = (newest + m - k) % m;
+            const _Domain* s = w.s.data() + slot * n;
+            const _Domain* y = w.y.data() + slot * n;
+            _Domain dot = 0;
+            for (size_t i = 0; i < n; ++i) {
+                dot += y[i] * q[i];
+            }
+            _Domain beta = w.rho[slot] * dot;
+            for (size_t i = 0; i < n; ++i) {
+                q[i] += (w.alpha[slot] - beta) * s[i];
+            }
+        }
+        for (size_t i = 0; i < n; ++i) {
+            q[i] = fixed(i, w) ? 0 : -q[i];
+        }
+    }
+
+    Minimum<_Domain> run(Workspace& w) const {
+        using std::fabs;
+        size_t n = variable_names.size();
+        size_t m = options.history;
+        Minimum<_Domain> result;
+        _Domain value = 0;
+        _Domain trial_value = 0;
+        ++result.evaluations;
+        if (!evaluate(w.x, value, w.gradient, w)) {
+            result.x = w.x;
+            return result;
+        }
+
+        size_t stored = 0;
+        size_t newest = 0;
+        result.status = RootStatus::MaxIterations;
+        while (true) {
+            result.gradient_norm = projected_gradient_norm(w);
+            if (result.gradient_norm <= options.gradient_tolerance) {
+                result.status = RootStatus::Converged;
+                break;
+            }
+            if (result.iterations == options.max_iterations) {
+                break;
+            }
+            ++result.iterations;
+
+            direction(stored, newest, w);
+            _Domain slope = 0;
+            for (size_t i = 0; i < n; ++i) {
+                slope += w.gradient[i] * w.direction[i];
+            }
+            if (!(slope < 0)) {
+                stored = 0;
+                direction(stored, newest, w);
+            }
+
+            _Domain step = 1;
+            if (stored == 0) {
+                step = std::min(_Domain(1), 1 / result.gradient_norm);
+            }
+            bool accepted = false;
+            for (size_t attempt = 0; attempt < options.max_line_search;
+                 ++attempt, step /= 2) {
+                _Domain decrease = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    w.trial[i] = std::clamp(w.x[i] + step * w.direction[i],
+                                            w.lower[i], w.upper[i]);
+                    decrease += w.gradient[i] * (w.trial[i] - w.x[i]);
+                }
+                ++result.evaluations;
+                if (evaluate(w.trial, trial_value, w.trial_gradient, w) &&
+                    trial_value <= value + _Domain(1e-4) * decrease) {
+                    accepted = true;
+                    break;
+                }
+            }
+            if (!accepted) {
+                if (stored > 0) {
+                    stored = 0;
+                    continue;
+                }
+                result.status = RootStatus::Failed;
+                break;
+            }
+
+            _Domain sy = 0;
+            _Domain yy = 0;
+            for (size_t i = 0; i < n; ++i) {
+                w.step[i] = w.trial[i] - w.x[i];
+                w.change[i] = w.trial_gradient[i] - w.gradient[i];
+                sy += w.step[i] * w.change[i];
+                yy += w.change[i] * w.change[i];
+            }
+            if (sy > std::numeric_limits<_Domain>::epsilon() * yy) {
+                size_t slot = stored == 0 ? 0 : (newest + 1) % m;
+                std::copy_n(w.step.begin(), n, w.s.begin() + slot * n);
+                std::copy_n(w.change.begin(), n, w.y.begin() + slot * n);
+                w.rho[slot] = 1 / sy;
+                newest = slot;
+                stored = std::min(stored + 1, m);
+            }
+
+            _Domain change = value - trial_value;
+            _Domain scale = std::max({fabs(value), fabs(trial_value),
+                                      _Domain(1)});
+            w.x.swap(w.trial);
+            w.gradient.swap(w.trial_gradient);
+            value = trial_value;
+            if (change <= options.value_tolerance * scale) {
+                result.gradient_norm = projected_gradient_norm(w);
+                result.status = RootStatus::Converged;
+                break;
+            }
+        }
+        result.x = w.x;
+        result.value = value;
+        return result;
+    }
+
+    std::vector<std::string> variable_names;
+    std::vector<std::string> parameter_names;
+    std::vector<uint32_t> slots;
+    MinimizerOptions options;
+    CompiledExpression<_Domain> kernel;
+};
+
+};  // namespace symcpp
+
+#endif  // MINIMIZE_HPP
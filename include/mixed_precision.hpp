@@ -0,0 +1,275 @@
+#ifndef MIXED_PRECISION_HPP
+#define MIXED_PRECISION_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "compiled.hpp"
+#include "profile.hpp"
+
+namespace symcpp {
+class MixedPrecisionEvaluator {
+   public:
+    static constexpr size_t block_size = 256;
+
+    struct Workspace {
+        std::vector<float> inputs, input_errors;
+        std::vector<float> values, errors;
+        std::vector<const float*> registers, error_registers;
+        std::vector<uint32_t> flagged;
+        std::vector<std::vector<double>> gathered, refined;
+        std::vector<const double*> gathered_columns;
+        std::vector<double*> refined_results;
+        CompiledExpression<double>::Workspace precise;
+    };
+
+    struct Statistics {
+        size_t rows = 0;
+        size_t refined = 0;
+    };
+
+    MixedPrecisionEvaluator() = default;
+    MixedPrecisionEvaluator(CompiledExpression<double> compiled,
+                            double tolerance)
+        : compiled(std::move(compiled)), tolerance(tolerance) {
+        for (double value : this->compiled.constants()) {
+            float rounded = static_cast<float>(value);
+            constant_values.push_back(rounded);
+            constant_errors.push_back(static_cast<float>(
+                std::fabs(static_cast<double>(rounded) - value)));
+        }
+    }
+
+    const std::vector<std::string>& variables() const {
+        return compiled.variables();
+    }
+    size_t outputs() const { return compiled.outputs().size(); }
+
+    void eval_batch(const double* const* columns, size_t rows,
+                    double* const* results, Workspace& workspace,
+                    Statistics* statistics = nullptr) const {
+        size_t variable_count = compiled.variables().size();
+        size_t output_count = outputs();
+        workspace.gathered.resize(variable_count);
+        workspace.refined.resize(output_count);
+        workspace.gathered_columns.resize(variable_count);
+        workspace.refined_results.resize(output_count);
+
+        for (size_t offset = 0; offset < rows; offset += block_size) {
+            size_t n = std::min(block_size, rows - offset);
+            workspace.flagged.clear();
+            approximate(columns, offset, n, workspace);
+            collect(offset, n, results, workspace);
+            refine(columns, offset, results, workspace);
+
+            if (statistics) {
+                statistics->rows += n;
+                statistics->refined += workspace.flagged.size();
+            }
+            profile::count(profile::Counter::Refinements,
+                           workspace.flagged.size());
+        }
+    }
+
+   private:
+    static constexpr float unit = std::numeric_limits<float>::epsilon() / 2;
+    static constexpr float infinity = std::numeric_limits<float>::infinity();
+
+    void approximate(const double* const* columns, size_t offset, size_t n,
+                     Workspace& workspace) const {
+        const auto& code = compiled.instructions();
+        size_t variable_count = compiled.variables().size();
+        profile::count(profile::Counter::Evaluations, code.size() * n);
+        workspace.inputs.resize(variable_count * n);
+        workspace.input_errors.resize(variable_count * n);
+        for (size_t v = 0; v < variable_count; ++v) {
+            const double* column = columns[v] + offset;
+            float* input = workspace.inputs.data() + v * n;
+            float* error = workspace.input_errors.data() + v * n;
+            for (size_t r = 0; r < n; ++r) {
+                input[r] = static_cast<float>(column[r]);
+                error[r] = static_cast<float>(
+                    std::fabs(static_cast<double>(input[r]) - column[r]));
+            }
+        }
+
+        workspace.values.resize(code.size() * n);
+        workspace.errors.resize(code.size() * n);
+        workspace.registers.resize(code.size());
+        workspace.error_registers.resize(code.size());
+
+        for (size_t i = 0; i < code.size(); ++i) {
+            const Instruction& instruction = code[i];
+            size_t arity = node_kind_arity(instruction.kind);
+            float* out = workspace.values.data() + i * n;
+            float* err = workspace.errors.data() + i * n;
+            const float* a = nullptr;
+            const float* da = nullptr;
+            const float* b = nullptr;
+            const float* db = nullptr;
+            if (arity > 0) {
+                a = workspace.registers[instruction.lhs];
+                da = workspace.error_registers[instruction.lhs];
+            }
+            if (arity > 1) {
+                b = workspace.registers[instruction.rhs];
+                db = workspace.error_registers[instruction.rhs];
+            }
+            workspace.registers[i] = out;
+            workspace.error_registers[i] = err;
+
+            switch (instruction.kind) {
+                case NodeKind::Value:
+                    std::fill_n(out, n, constant_values[instruction.lhs]);
+                    std::fill_n(err, n, constant_errors[instruction.lhs]);
+                    break;
+                case NodeKind::Variable:
+                    workspace.registers[i] =
+                        workspace.inputs.data() + instruction.lhs * n;
+                    workspace.error_registers[i] =
+                        workspace.input_errors.data() + instruction.lhs * n;
+                    break;
+                case NodeKind::Add:
+                    for (size_t r = 0; r < n; ++r) {
+                        out[r] = a[r] + b[r];
+                        err[r] = da[r] + db[r] + unit * std::fabs(out[r]);
+                    }
+                    break;
+                case NodeKind::Subtract:
+                    for (size_t r = 0; r < n; ++r) {
+                        out[r] = a[r] - b[r];
+                        err[r] = da[r] + db[r] + unit * std::fabs(out[r]);
+                    }
+                    break;
+                case NodeKind::Multiply:
+                    for (size_t r = 0; r < n; ++r) {
+                        out[r] = a[r] * b[r];
+                        err[r] = std::fabs(a[r]) * db[r] +
+                                 std::fabs(b[r]) * da[r] + da[r] * db[r] +
+                                 unit * std::fabs(out[r]);
+                    }
+                    break;
+                case NodeKind::Divide:
+                    for (size_t r = 0; r < n; ++r) {
+                        out[r] = a[r] / b[r];
+                        float margin = std::fabs(b[r]) - db[r];
+                        float spread = da[r] + std::fabs(out[r]) * db[r];
+                        err[r] = margin > 0 ? spread / margin +
+                                                  unit * std::fabs(out[r])
+                                            : infinity;
+                    }
+                    break;
+                case NodeKind::Power:
+                    for (size_t r = 0; r < n; ++r) {
+                        out[r] = std::pow(a[r], b[r]);
+                        float base = da[r] > 0
+                                         ? std::fabs(b[r] * out[r] / a[r])
+                                         : 0.0f;
+                        float exponent =
+                            db[r] > 0
+                                ? std::fabs(out[r] * std::log(std::fabs(a[r])))
+                                : 0.0f;
+                        err[r] = base * da[r] + exponent * db[r] +
+                                 2 * unit * std::fabs(out[r]);
+                    }
+                    break;
+                case NodeKind::Sin:
+                    for (size_t r = 0; r < n; ++r) {
+                        out[r] = std::sin(a[r]);
+                        err[r] = std::min(std::fabs(std::cos(a[r])) + da[r],
+                                          1.0f) *
+                                     da[r] +
+                                 2 * unit * std::fabs(out[r]);
+                    }
+                    break;
+                case NodeKind::Cos:
+                    for (size_t r = 0; r < n; ++r) {
+                        out[r] = std::cos(a[r]);
+                        err[r] = std::min(std::fabs(std::sin(a[r])) + da[r],
+                                          1.0f) *
+                                     da[r] +
+                                 2 * unit * std::fabs(out[r]);
+                    }
+                    break;
+                case NodeKind::Ln:
+                    for (size_t r = 0; r < n; ++r) {
+                        out[r] = std::log(a[r]);
+                        float margin = a[r] - da[r];
+                        err[r] = margin > 0 ? da[r] / margin +
+                                                  2 * unit * std::fabs(out[r])
+                                            : infinity;
+                    }
+                    break;
+                case NodeKind::Exp:
+                    for (size_t r = 0; r < n; ++r) {
+                        out[r] = std::exp(a[r]);
+                        err[r] = out[r] * std::expm1(da[r]) +
+                                 2 * unit * out[r];
+                    }
+                    break;
+            }
+        }
+    }
+
+    void collect(size_t offset, size_t n, double* const* results,
+                 Workspace& workspace) const {
+        const auto& outputs = compiled.outputs();
+        for (size_t r = 0; r < n; ++r) {
+            bool accurate = true;
+            for (uint32_t reg : outputs) {
+                float value = workspace.registers[reg][r];
+                float error = workspace.error_registers[reg][r];
+                accurate &= std::isfinite(value) &&
+                            error <= tolerance * std::fabs(value);
+            }
+            if (!accurate) {
+                workspace.flagged.push_back(static_cast<uint32_t>(r));
+            }
+        }
+        for (size_t k = 0; k < outputs.size(); ++k) {
+            const float* values = workspace.registers[outputs[k]];
+            std::copy_n(values, n, results[k] + offset);
+        }
+    }
+
+    void refine(const double* const* columns, size_t offset,
+                double* const* results, Workspace& workspace) const {
+        size_t count = workspace.flagged.size();
+        if (count == 0) {
+            return;
+        }
+        for (size_t v = 0; v < workspace.gathered.size(); ++v) {
+            workspace.gathered[v].resize(count);
+            for (size_t j = 0; j < count; ++j) {
+                workspace.gathered[v][j] =
+                    columns[v][offset + workspace.flagged[j]];
+            }
+            workspace.gathered_columns[v] = workspace.gathered[v].data();
+        }
+        for (size_t k = 0; k < workspace.refined.size(); ++k) {
+            workspace.refined[k].resize(count);
+            workspace.refined_results[k] = workspace.refined[k].data();
+        }
+        compiled.eval_batch(workspace.gathered_columns.data(), count,
+                            workspace.refined_results.data(),
+                            workspace.precise);
+        for (size_t k = 0; k < workspace.refined.size(); ++k) {
+            for (size_t j = 0; j < count; ++j) {
+                results[k][offset + workspace.flagged[j]] =
+                    workspace.refined[k][j];
+            }
+        }
+    }
+
+    CompiledExpression<double> compiled;
+    std::vector<float> constant_values, constant_errors;
+    double tolerance = 0;
+};
+
+};  // namespace symcpp
+
+#endif  // MIXED_PRECISION_HPP
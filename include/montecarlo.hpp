@@ -0,0 +1,472 @@
+#ifndef MONTECARLO_HPP
+#define MONTECARLO_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "compiled.hpp"
+#include "expression.hpp"
+#include "parallel.hpp"
+
+namespace symcpp {
+class Philox4x32 {
+   public:
+    using Block = std::array<uint32_t, 4>;
+
+    static Block generate(Block counter, uint64_t seed) {
+        uint32_t k0 = static_cast<uint32_t>(seed);
+        uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+        for (int round = 0; round < 10; ++round) {
+            uint64_t p0 = uint64_t(0xD2511F53) * counter[0];
+            uint64_t p1 = uint64_t(0xCD9E8D57) * counter[2];
+            counter = {static_cast<uint32_t>(p1 >> 32) ^ counter[1] ^ k0,
+                       static_cast<uint32_t>(p1),
+                       static_cast<uint32_t>(p0 >> 32) ^ counter[3] ^ k1,
+                       static_cast<uint32_t>(p0)};
+            k0 += 0x9E3779B9;
+            k1 += 0xBB67AE85;
+        }
+        return counter;
+    }
+
+    static double uniform(uint64_t index, uint32_t stream, uint64_t seed) {
+        Block bits = generate({static_cast<uint32_t>(index),
+                               static_cast<uint32_t>(index >> 32), stream, 0},
+                              seed);
+        uint64_t word = (uint64_t(bits[0]) << 32 | bits[1]) >> 11;
+        return (static_cast<double>(word) + 0.5) * 0x1p-53;
+    }
+};
+
+class Sobol {
+   public:
+    static constexpr size_t max_dimensions = 16;
+    static constexpr size_t bits = 32;
+
+    explicit Sobol(size_t dimensions, uint64_t seed = 0)
+        : dimensions(dimensions), shift(dimensions, 0) {
+        if (dimensions > max_dimensions) {
+            throw std::runtime_error("Sobol sequence supports at most " +
+                                     std::to_string(max_dimensions) +
+                                     " dimensions");
+        }
+        directions.resize(dimensions * bits);
+        for (size_t d = 0; d < dimensions; ++d) {
+            uint32_t* v = directions.data() + d * bits;
+            if (d == 0) {
+                for (size_t i = 0; i < bits; ++i) {
+                    v[i] = uint32_t(1) << (31 - i);
+                }
+            } else {
+                const Primitive& p = primitives[d - 1];
+                for (size_t i = 0; i < p.degree; ++i) {
+                    v[i] = p.initial[i] << (31 - i);
+                }
+                for (size_t i = p.degree; i < bits; ++i) {
+                    v[i] = v[i - p.degree] ^ (v[i - p.degree] >> p.degree);
+                    for (size_t k = 1; k < p.degree; ++k) {
+                        if ((p.coefficients >> (p.degree - 1 - k)) & 1) {
+                            v[i] ^= v[i - k];
+                        }
+                    }
+                }
+            }
+            if (seed != 0) {
+                shift[d] = Philox4x32::generate(
+                    {static_cast<uint32_t>(d), 0, 0, 0}, seed)[0];
+            }
+        }
+    }
+
+    void point(uint64_t index, uint32_t* out) const {
+        uint64_t gray = index ^ (index >> 1);
+        for (size_t d = 0; d < dimensions; ++d) {
+            const uint32_t* v = directions.data() + d * bits;
+            uint32_t x = shift[d];
+            for (uint64_t g = gray; g != 0; g &= g - 1) {
+                x ^= v[std::countr_zero(g)];
+            }
+            out[d] = x;
+        }
+    }
+
+    void next(uint64_t index, uint32_t* state) const {
+        size_t bit = std::countr_zero(~index);
+        for (size_t d = 0; d < dimensions; ++d) {
+            state[d] ^= directions[d * bits + bit];
+        }
+    }
+
+    static double uniform(uint32_t x) {
+        return (static_cast<double>(x) + 0.5) * 0x1p-32;
+    }
+
+   private:
+    struct Primitive {
+        uint32_t degree, coefficients;
+        uint32_t initial[6];
+    };
+
+    static constexpr Primitive primitives[max_dimensions - 1] = {
+        {1, 0, {1}},
+        {2, 1, {1, 3}},
+        {3, 1, {1, 3, 1}},
+        {3, 2, {1, 1, 1}},
+        {4, 1, {1, 1, 3, 3}},
+        {4, 4, {1, 3, 5, 13}},
+        {5, 2, {1, 1, 5, 5, 17}},
+        {5, 4, {1, 1, 5, 5, 5}},
+        {5, 7, {1, 1, 7, 11, 19}},
+        {5, 11, {1, 1, 5, 1, 1}},
+        {5, 13, {1, 1, 1, 3, 11}},
+        {5, 14, {1, 3, 5, 5, 31}},
+        {6, 1, {1, 3, 3, 9, 7, 49}},
+        {6, 13, {1, 1, 1, 15, 21, 21}},
+        {6, 16, {1, 3, 1, 13, 27, 49}},
+    };
+
+    size_t dimensions;
+    std::vector<uint32_t> directions;
+    std::vector<uint32_t> shift;
+};
+
+inline double inverse_normal(double p) {
+    static constexpr double a[] = {
+        -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+        1.383577518672690e+02,  -3.066479806614716e+01, 2.506628277459239e+00};
+    static constexpr double b[] = {
+        -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+        6.680131188771972e+01, -1.328068155288572e+01};
+    static constexpr double c[] = {
+        -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+        -2.549732539343734e+00, 4.374664141464968e+00,  2.938163982698783e+00};
+    static constexpr double d[] = {
+        7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+        3.754408661907416e+00};
+    double x;
+    if (p < 0.02425) {
+        double q = std::sqrt(-2 * std::log(p));
+        x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q +
+             c[5]) /
+            ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    } else if (p > 1 - 0.02425) {
+        double q = std::sqrt(-2 * std::log1p(-p));
+        x = -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q +
+              c[5]) /
+            ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    } else {
+        double q = p - 0.5;
+        double r = q * q;
+        x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r +
+             a[5]) *
+            q /
+            (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+    }
+    double e = 0.5 * std::erfc(-x / std::sqrt(2.0)) - p;
+    double u = e * std::sqrt(2 * std::numbers::pi) * std::exp(x * x / 2);
+    return x - u / (1 + x * u / 2);
+}
+
+struct Distribution {
+    enum class Kind : uint8_t {
+        Uniform,
+        Normal,
+    };
+
+    Kind kind = Kind::Uniform;
+    double first = 0;
+    double second = 1;
+
+    static Distribution uniform(double lower, double upper) {
+        return {Kind::Uniform, lower, upper};
+    }
+    static Distribution normal(double mean, double deviation) {
+        return {Kind::Normal, mean, deviation};
+    }
+
+    double transform(double u) const {
+        if (kind == Kind::Uniform) {
+            return first + (second - first) * u;
+        }
+        return first + second * inverse_normal(u);
+    }
+};
+
+struct MonteCarloOptions {
+    uint64_t seed = 0;
+    bool sobol = false;
+    size_t threads = 0;
+    size_t bins = 4096;
+    std::vector<double> quantiles = {0.05, 0.5, 0.95};
+};
+
+struct MonteCarloResult {
+    size_t samples = 0;
+    size_t failures = 0;
+    double mean = 0;
+    double variance = 0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    std::vector<double> quantiles;
+
+    double standard_error() const {
+        return samples > 1 ? std::sqrt(variance / samples) : 0.0;
+    }
+};
+
+template <typename _Domain = double>
+    requires std::is_floating_point_v<_Domain>
+class MonteCarlo {
+   public:
+    static constexpr size_t block_size =
+        CompiledExpression<_Domain>::block_size;
+
+    MonteCarlo(const Expression<_Domain>& expr,
+               std::map<std::string, Distribution> inputs,
+               MonteCarloOptions options = {})
+        : kernel(expr), options(std::move(options)) {
+        for (const auto& name : kernel.variables()) {
+            auto it = inputs.find(name);
+            if (it == inputs.end()) {
+                parameter_names.push_back(name);
+                random.push_back(-1);
+            } else {
+                random.push_back(static_cast<int>(distributions.size()));
+                distributions.push_back(it->second);
+            }
+        }
+        if (this->options.sobol) {
+            sobol = Sobol(distributions.size(), this->options.seed);
+        }
+    }
+
+    const std::vector<std::string>& parameters() const {
+        return parameter_names;
+    }
+
+    MonteCarloResult run(
+        size_t samples,
+        const std::map<std::string, _Domain>& values = {}) const {
+        std::vector<_Domain> fixed;
+        for (const auto& name : parameter_names) {
+            auto it = values.find(name);
+            if (it == values.end()) {
+                throw std::runtime_error("Variable not found: " + name);
+            }
+            fixed.push_back(it->second);
+        }
+
+        size_t blocks = (samples + block_size - 1) / block_size;
+        Accumulator pilot(0, 0, 0);
+        if (blocks > 0) {
+            Worker worker(*this, fixed);
+            worker.run(0, std::min(block_size, samples), pilot);
+        }
+        double span = pilot.max > pilot.min ? pilot.max - pilot.min : 1.0;
+        double lower = std::isfinite(pilot.min) ? pilot.min - span / 2 : 0;
+        double upper = std::isfinite(pilot.max) ? pilot.max + span / 2 : 1;
+
+        size_t threads = options.threads ? options.threads : default_threads();
+        threads = std::max<size_t>(1, std::min(threads, blocks));
+        std::vector<Accumulator> partial(threads,
+                                         Accumulator(options.bins, lower,
+                                                     upper));
+        parallel_for(
+            threads,
+            [&](size_t begin, size_t end) {
+                Worker worker(*this, fixed);
+                for (size_t t = begin; t < end; ++t) {
+                    size_t first = blocks * t / threads;
+                    size_t last = blocks * (t + 1) / threads;
+                    for (size_t block = first; block < last; ++block) {
+                        size_t offset = block * block_size;
+                        worker.run(offset,
+                                   std::min(block_size, samples - offset),
+                                   partial[t]);
+                    }
+                }
+            },
+            threads);
+
+        Accumulator total(options.bins, lower, upper);
+        for (const auto& part : partial) {
+            total.merge(part);
+        }
+        return total.result(options.quantiles);
+    }
+
+   private:
+    struct Accumulator {
+        Accumulator(size_t bins, double lower, double upper)
+            : lower(lower),
+              width((upper - lower) / std::max<size_t>(bins, 1)),
+              counts(bins + 2, 0) {}
+
+        void add(double value) {
+            ++count;
+            double delta = value - mean;
+            mean += delta / static_cast<double>(count);
+            m2 += delta * (value - mean);
+            min = std::min(min, value);
+            max = std::max(max, value);
+            if (counts.size() > 2) {
+                double position = (value - lower) / width;
+                size_t bin = position < 0 ? 0
+                             : position >= static_cast<double>(
+                                               counts.size() - 2)
+                                 ? counts.size() - 1
+                                 : 1 + static_cast<size_t>(position);
+                ++counts[bin];
+            }
+        }
+
+        void merge(const Accumulator& other) {
+            if (other.count == 0) {
+                failures += other.failures;
+                return;
+            }
+            size_t total = count + other.count;
+            double delta = other.mean - mean;
+            mean += delta * static_cast<double>(other.count) /
+                    static_cast<double>(total);
+            m2 += other.m2 + delta * delta * static_cast<double>(count) *
+                                 static_cast<double>(other.count) /
+                                 static_cast<double>(total);
+            count = total;
+            failures += other.failures;
+            min = std::min(min, other.min);
+            max = std::max(max, other.max);
+            for (size_t i = 0; i < counts.size(); ++i) {
+                counts[i] += other.counts[i];
+            }
+        }
+
+        double quantile(double q) const {
+            double rank = q * static_cast<double>(count);
+            double seen = 0;
+            size_t last = counts.size() - 1;
+            for (size_t i = 0; i <= last; ++i) {
+                double next = seen + static_cast<double>(counts[i]);
+                if (counts[i] > 0 && next >= rank) {
+                    double from = i == 0 ? min : lower + width * (i - 1);
+                    double to = i == last ? max : lower + width * i;
+                    double t = (rank - seen) / static_cast<double>(counts[i]);
+                    return std::clamp(from + t * (to - from), min, max);
+                }
+                seen = next;
+            }
+            return max;
+        }
+
+        MonteCarloResult result(const std::vector<double>& levels) const {
+            MonteCarloResult out;
+            out.samples = count;
+            out.failures = failures;
+            out.mean = mean;
+            out.variance = count > 1 ? m2 / static_cast<double>(count - 1) : 0;
+            out.min = min;
+            out.max = max;
+            for (double level : levels) {
+                out.quantiles.push_back(
+                    count > 0 ? quantile(level)
+                              : std::numeric_limits<double>::quiet_NaN());
+            }
+            return out;
+        }
+
+        size_t count = 0;
+        size_t failures = 0;
+        double mean = 0;
+        double m2 = 0;
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+        double lower, width;
+        std::vector<uint64_t> counts;
+    };
+
+    struct Worker {
+        Worker(const MonteCarlo& owner, const std::vector<_Domain>& fixed)
+            : owner(owner),
+              columns(owner.random.size(), std::vector<_Domain>(block_size)),
+              pointers(owner.random.size()),
+              results(block_size),
+              state(owner.distributions.size()) {
+            for (size_t v = 0, p = 0; v < columns.size(); ++v) {
+                if (owner.random[v] < 0) {
+                    std::fill(columns[v].begin(), columns[v].end(),
+                              fixed[p++]);
+                }
+                pointers[v] = columns[v].data();
+            }
+        }
+
+        void run(size_t offset, size_t n, Accumulator& accumulator) {
+            generate(offset, n);
+            _Domain* out[] = {results.data()};
+            owner.kernel.eval_batch_or_nan(pointers.data(), n, out, workspace);
+            for (size_t r = 0; r < n; ++r) {
+                double value = static_cast<double>(results[r]);
+                if (std::isfinite(value)) {
+                    accumulator.add(value);
+                } else {
+                    ++accumulator.failures;
+                }
+            }
+        }
+
+        void generate(size_t offset, size_t n) {
+            const auto& random = owner.random;
+            const auto& distributions = owner.distributions;
+            if (owner.options.sobol) {
+                owner.sobol.point(offset + 1, state.data());
+            }
+            for (size_t r = 0; r < n; ++r) {
+                if (owner.options.sobol && r > 0) {
+                    owner.sobol.next(offset + r, state.data());
+                }
+                for (size_t v = 0; v < random.size(); ++v) {
+                    if (random[v] < 0) {
+                        continue;
+                    }
+                    double u = owner.options.sobol
+                                   ? Sobol::uniform(state[random[v]])
+                                   : Philox4x32::uniform(
+                                         offset + r,
+                                         static_cast<uint32_t>(random[v]),
+                                         owner.options.seed);
+                    columns[v][r] =
+                        static_cast<_Domain>(distributions[random[v]]
+                                                 .transform(u));
+                }
+            }
+        }
+
+        const MonteCarlo& owner;
+        std::vector<std::vector<_Domain>> columns;
+        std::vector<const _Domain*> pointers;
+        std::vector<_Domain> results;
+        std::vector<uint32_t> state;
+        typename CompiledExpression<_Domain>::Workspace workspace;
+    };
+
+    CompiledExpression<_Domain> kernel;
+    MonteCarloOptions options;
+    std::vector<std::string> parameter_names;
+    std::vector<int> random;
+    std::vector<Distribution> distributions;
+    Sobol sobol{0};
+};
+
+};  // namespace symcpp
+
+#endif  // MONTECARLO_HPP
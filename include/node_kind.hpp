@@ -0,0 +1,69 @@
+#ifndef NODE_KIND_HPP
+#define NODE_KIND_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace symcpp {
+enum class NodeKind : uint8_t {
+    Value,
+    Variable,
+    Add,
+    Subtract,
+    Multiply,
+    Divide,
+    Power,
+    Sin,
+    Cos,
+    Ln,
+    Exp,
+};
+
+inline constexpr size_t node_kind_count = 11;
+
+inline const char* node_kind_name(NodeKind kind) {
+    switch (kind) {
+        case NodeKind::Value:
+            return "Value";
+        case NodeKind::Variable:
+            return "Variable";
+        case NodeKind::Add:
+            return "Add";
+        case NodeKind::Subtract:
+            return "Subtract";
+        case NodeKind::Multiply:
+            return "Multiply";
+        case NodeKind::Divide:
+            return "Divide";
+        case NodeKind::Power:
+            return "Power";
+        case NodeKind::Sin:
+            return "Sin";
+        case NodeKind::Cos:
+            return "Cos";
+        case NodeKind::Ln:
+            return "Ln";
+        case NodeKind::Exp:
+            return "Exp";
+    }
+    return "Unknown";
+}
+
+inline size_t node_kind_arity(NodeKind kind) {
+    switch (kind) {
+        case NodeKind::Value:
+        case NodeKind::Variable:
+            return 0;
+        case NodeKind::Sin:
+        case NodeKind::Cos:
+        case NodeKind::Ln:
+        case NodeKind::Exp:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+};  // namespace symcpp
+
+#endif  // NODE_KIND_HPP
@@ -0,0 +1,274 @@
+#ifndef NODE_PROFILE_HPP
+#define NODE_PROFILE_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "expression.hpp"
+#include "profile.hpp"
+
+namespace symcpp {
+namespace detail {
+inline uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+};  // namespace detail
+
+template <typename _Domain>
+struct NodeStats {
+    Expression<_Domain> expr;
+    NodeKind kind;
+    uint64_t evaluations = 0;
+    double seconds = 0;
+    double self_seconds = 0;
+};
+
+struct KindStats {
+    NodeKind kind;
+    uint64_t evaluations = 0;
+    double self_seconds = 0;
+};
+
+template <Numeric _Domain = Reals_t>
+class ProfilingEvaluator {
+   public:
+    explicit ProfilingEvaluator(const Expression<_Domain>& expr,
+                                size_t period = 16)
+        : period(std::max<size_t>(period, 1)) {
+        std::unordered_map<const void*, uint32_t> memo;
+        root = flatten(expr, memo);
+        reset();
+    }
+
+    _Domain eval(const std::map<std::string, _Domain>& variables) {
+        ++evaluations;
+        if (evaluations % period != 0) {
+            return run<false>(root, variables, nullptr);
+        }
+        ++sampled;
+        uint64_t elapsed = 0;
+        return run<true>(root, variables, &elapsed);
+    }
+
+    void reset() {
+        for (auto& node : nodes) {
+            node.evaluations = 0;
+            node.ticks = 0;
+            node.self_ticks = 0;
+        }
+        evaluations = 0;
+        sampled = 0;
+        start_ticks = detail::ticks();
+        start_time = std::chrono::steady_clock::now();
+    }
+
+    uint64_t calls() const { return evaluations; }
+
+    std::vector<NodeStats<_Domain>> hottest() const {
+        double scale = seconds_per_tick() *
+                       (sampled ? double(evaluations) / double(sampled) : 0);
+        std::vector<NodeStats<_Domain>> result;
+        for (const auto& node : nodes) {
+            result.push_back({node.expr, node.kind, node.evaluations,
+                              double(node.ticks) * scale,
+                              double(node.self_ticks) * scale});
+        }
+        std::stable_sort(result.begin(), result.end(),
+                         [](const auto& a, const auto& b) {
+                             return a.self_seconds > b.self_seconds;
+                         });
+        return result;
+    }
+
+    std::vector<KindStats> kinds() const {
+        std::vector<KindStats> result;
+        for (size_t k = 0; k < node_kind_count; ++k) {
+            result.push_back({static_cast<NodeKind>(k)});
+        }
+        for (const auto& node : hottest()) {
+            KindStats& stats = result[static_cast<size_t>(node.kind)];
+            stats.evaluations += node.evaluations;
+            stats.self_seconds += node.self_seconds;
+        }
+        std::stable_sort(result.begin(), result.end(),
+                         [](const auto& a, const auto& b) {
+                             return a.self_seconds > b.self_seconds;
+                         });
+        return result;
+    }
+
+    void report(std::ostream& os, size_t top = 10,
+                size_t width = 72) const {
+        std::ios_base::fmtflags flags = os.flags();
+        std::streamsize precision = os.precision();
+        os << std::left << std::setw(16) << "kind" << std::right
+           << std::setw(14) << "evaluations" << std::setw(14) << "self, ms"
+           << '\n';
+        for (const auto& stats : kinds()) {
+            if (stats.evaluations == 0) {
+                continue;
+            }
+            os << std::left << std::setw(16) << node_kind_name(stats.kind)
+               << std::right << std::setw(14) << stats.evaluations
+               << std::fixed << std::setprecision(3) << std::setw(14)
+               << stats.self_seconds * 1e3 << '\n';
+        }
+
+        os << '\n'
+           << std::right << std::setw(14) << "self, ms" << std::setw(14)
+           << "total, ms" << std::setw(14) << "evaluations"
+           << "  subexpression\n";
+        auto nodes = hottest();
+        for (size_t i = 0; i < std::min(top, nodes.size()); ++i) {
+            std::string text = nodes[i].expr.to_string();
+            if (text.size() > width) {
+                text = text.substr(0, width - 3) + "...";
+            }
+            os << std::fixed << std::setprecision(3) << std::setw(14)
+               << nodes[i].self_seconds * 1e3 << std::setw(14)
+               << nodes[i].seconds * 1e3 << std::setw(14)
+               << nodes[i].evaluations << "  " << text << '\n';
+        }
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+   private:
+    struct Node {
+        Expression<_Domain> expr;
+        NodeKind kind;
+        uint32_t operands[2] = {0, 0};
+        uint64_t evaluations = 0;
+        uint64_t ticks = 0;
+        uint64_t self_ticks = 0;
+    };
+
+    uint32_t flatten(const Expression<_Domain>& expr,
+                     std::unordered_map<const void*, uint32_t>& memo) {
+        auto known = memo.find(expr.id());
+        if (known != memo.end()) {
+            return known->second;
+        }
+        Node node{expr, expr.kind()};
+        for (size_t i = 0; i < node_kind_arity(node.kind); ++i) {
+            node.operands[i] = flatten(expr.operand(i), memo);
+        }
+        nodes.push_back(std::move(node));
+        uint32_t index = static_cast<uint32_t>(nodes.size() - 1);
+        memo.emplace(expr.id(), index);
+        return index;
+    }
+
+    double seconds_per_tick() const {
+        uint64_t span = detail::ticks() - start_ticks;
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start_time;
+        return span ? elapsed.count() / double(span) : 0;
+    }
+
+    template <bool _Timed>
+    _Domain run(uint32_t index,
+                const std::map<std::string, _Domain>& variables,
+                uint64_t* elapsed) {
+        Node& node = nodes[index];
+        ++node.evaluations;
+        uint64_t start = _Timed ? detail::ticks() : 0;
+        uint64_t children = 0;
+        _Domain result{};
+        switch (node.kind) {
+            case NodeKind::Value:
+            case NodeKind::Variable:
+                result = node.expr.eval(variables);
+                break;
+            case NodeKind::Add:
+                result = run<_Timed>(node.operands[0], variables, &children) +
+                         run<_Timed>(node.operands[1], variables, &children);
+                break;
+            case NodeKind::Subtract:
+                result = run<_Timed>(node.operands[0], variables, &children) -
+                         run<_Timed>(node.operands[1], variables, &children);
+                break;
+            case NodeKind::Multiply:
+                result = run<_Timed>(node.operands[0], variables, &children) *
+                         run<_Timed>(node.operands[1], variables, &children);
+                break;
+            case NodeKind::Divide: {
+                _Domain divider =
+                    run<_Timed>(node.operands[1], variables, &children);
+                if (divider == _Domain(0.)) {
+                    profile::count(profile::Counter::Exceptions);
+                    throw std::runtime_error("Division by zero");
+                }
+                result = run<_Timed>(node.operands[0], variables, &children) /
+                         divider;
+                break;
+            }
+            case NodeKind::Power: {
+                _Domain base =
+                    run<_Timed>(node.operands[0], variables, &children);
+                result = detail::pow(
+                    base, run<_Timed>(node.operands[1], variables, &children));
+                break;
+            }
+            case NodeKind::Sin:
+                result = detail::sin(
+                    run<_Timed>(node.operands[0], variables, &children));
+                break;
+            case NodeKind::Cos:
+                result = detail::cos(
+                    run<_Timed>(node.operands[0], variables, &children));
+                break;
+            case NodeKind::Ln: {
+                _Domain argument =
+                    run<_Timed>(node.operands[0], variables, &children);
+                if (detail::outside_log_domain(argument)) {
+                    profile::count(profile::Counter::Exceptions);
+                    throw std::runtime_error("Ln domain error");
+                }
+                result = detail::log(argument);
+                break;
+            }
+            case NodeKind::Exp:
+                result = detail::exp(
+                    run<_Timed>(node.operands[0], variables, &children));
+                break;
+        }
+        if constexpr (_Timed) {
+            uint64_t spent = detail::ticks() - start;
+            node.ticks += spent;
+            node.self_ticks += spent > children ? spent - children : 0;
+            *elapsed += spent;
+        }
+        return result;
+    }
+
+    std::vector<Node> nodes;
+    uint32_t root = 0;
+    size_t period;
+    uint64_t evaluations = 0;
+    uint64_t sampled = 0;
+    uint64_t start_ticks = 0;
+    std::chrono::steady_clock::time_point start_time;
+};
+
+};  // namespace symcpp
+
+#endif  // NODE_PROFILE_HPP
@@ -0,0 +1,405 @@
+#ifndef ODE_HPP
+#define ODE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "compiled.hpp"
+#include "dense.hpp"
+#include "expression.hpp"
+#include "parallel.hpp"
+
+namespace symcpp {
+enum class OdeMethod : uint8_t {
+    DormandPrince,
+    Rosenbrock,
+};
+
+struct OdeOptions {
+    OdeMethod method = OdeMethod::DormandPrince;
+    double absolute_tolerance = 1e-8;
+    double relative_tolerance = 1e-8;
+    double initial_step = 0;
+    size_t max_steps = 100000;
+    size_t threads = 0;
+};
+
+template <typename _Domain>
+struct OdeResult {
+    std::vector<_Domain> y;
+    _Domain t{};
+    size_t steps = 0;
+    size_t rejected = 0;
+    bool success = false;
+};
+
+template <typename _Domain = double>
+    requires std::is_floating_point_v<_Domain>
+class OdeSystem {
+   public:
+    struct Entry {
+        uint32_t row, column;
+    };
+
+    struct Workspace {
+        std::vector<_Domain> point, inputs, outputs;
+        std::vector<_Domain> y, next, error, stage, stages;
+        std::vector<_Domain> jacobian, matrix, time_derivative;
+        LuFactorization<_Domain> lu;
+        typename CompiledExpression<_Domain>::Workspace kernel;
+    };
+
+    OdeSystem(const std::vector<Expression<_Domain>>& rhs,
+              std::vector<std::string> states, std::string time = "t",
+              OdeOptions options = {})
+        : state_names(std::move(states)),
+          time_name(std::move(time)),
+          options(options),
+          rhs_kernel(rhs) {
+        if (rhs.size() != state_names.size()) {
+            throw std::runtime_error(
+                "Right-hand side size does not match the state");
+        }
+        std::vector<std::string> bound{time_name};
+        bound.insert(bound.end(), state_names.begin(), state_names.end());
+        rhs_slots = rhs_kernel.slots(bound, parameter_names);
+        if (options.method != OdeMethod::Rosenbrock) {
+            return;
+        }
+
+        std::vector<std::string> columns = state_names;
+        columns.push_back(time_name);
+        std::vector<Expression<_Domain>> outputs = rhs;
+        for (size_t i = 0; i < rhs.size(); ++i) {
+            auto partials = rhs[i].gradient(columns);
+            for (size_t j = 0; j < columns.size(); ++j) {
+                const Expression<_Domain>& derivative = partials[j];
+                if (derivative.kind() == NodeKind::Value &&
+                    derivative.value() == 0) {
+                    continue;
+                }
+                entries.push_back(
+                    {static_cast<uint32_t>(i), static_cast<uint32_t>(j)});
+                outputs.push_back(derivative);
+            }
+        }
+        jacobian_kernel = CompiledExpression<_Domain>(outputs);
+        jacobian_slots = jacobian_kernel.slots(bound, parameter_names);
+    }
+
+    size_t dimension() const { return state_names.size(); }
+    const std::vector<std::string>& parameters() const {
+        return parameter_names;
+    }
+
+    OdeResult<_Domain> integrate(
+        const std::vector<_Domain>& initial, _Domain t0, _Domain t1,
+        const std::map<std::string, _Domain>& values = {},
+        Workspace* workspace = nullptr) const {
+        if (initial.size() != dimension()) {
+            throw std::runtime_error("Initial state has wrong size");
+        }
+        Workspace local;
+        Workspace& w = workspace ? *workspace : local;
+        bind(values, w);
+        w.y = initial;
+        return run(t0, t1, w);
+    }
+
+    void integrate_batch(const _Domain* initial, size_t count, _Domain t0,
+                         _Domain t1,
+                         const std::map<std::string, _Domain>& values,
+                         _Domain* final_states,
+                         bool* success = nullptr) const {
+        size_t n = dimension();
+        parallel_for(
+            count,
+            [&](size_t begin, size_t end) {
+                Workspace w;
+                bind(values, w);
+                for (size_t p = begin; p < end; ++p) {
+                    w.y.assign(initial + p * n, initial + (p + 1) * n);
+                    OdeResult<_Domain> result = run(t0, t1, w);
+                    std::copy(result.y.begin(), result.y.end(),
+                              final_states + p * n);
+                    if (success) {
+                        success[p] = result.success;
+                    }
+                }
+            },
+            options.threads);
+    }
+
+   private:
+    static constexpr double c[7] = {0,       1.0 / 5, 3.0 / 10, 4.0 / 5,
+                                    8.0 / 9, 1,       1};
+    static constexpr double a[7][6] = {
+        {},
+        {1.0 / 5},
+        {3.0 / 40, 9.0 / 40},
+        {44.0 / 45, -56.0 / 15, 32.0 / 9},
+        {19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729},
+        {9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176,
+         -5103.0 / 18656},
+        {35.0 / 384, 0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784,
+         11.0 / 84},
+    };
+    static constexpr double e[7] = {71.0 / 57600,     0,
+                                    -71.0 / 16695,    71.0 / 1920,
+                                    -17253.0 / 339200, 22.0 / 525,
+                                    -1.0 / 40};
+
+    void bind(const std::map<std::string, _Domain>& values,
+              Workspace& w) const {
+        size_t n = dimension();
+        w.point.assign(1 + n, _Domain(0));
+        for (const auto& name : parameter_names) {
+            auto it = values.find(name);
+            if (it == values.end()) {
+                throw std::runtime_error("Variable not found: " + name);
+            }
+            w.point.push_back(it->second);
+        }
+        w.next.resize(n);
+        w.error.resize(n);
+        w.stage.resize(n);
+        w.stages.resize(7 * n);
+        if (options.method == OdeMethod::Rosenbrock) {
+            w.jacobian.resize(n * n);
+            w.matrix.resize(n * n);
+            w.time_derivative.resize(n);
+            w.outputs.resize(n + entries.size());
+        }
+    }
+
+    void run_kernel(const CompiledExpression<_Domain>& kernel,
+                    const std::vector<uint32_t>& slot, _Domain t,
+                    const _Domain* y, _Domain* out, Workspace& w) const {
+        w.point[0] = t;
+        std::copy_n(y, dimension(), w.point.begin() + 1);
+        w.inputs.resize(slot.size());
+        for (size_t v = 0; v < slot.size(); ++v) {
+            w.inputs[v] = w.point[slot[v]];
+        }
+        kernel.eval(w.inputs.data(), out, w.kernel);
+    }
+
+    void rhs(_Domain t, const _Domain* y, _Domain* out, Workspace& w) const {
+        run_kernel(rhs_kernel, rhs_slots, t, y, out, w);
+    }
+
+    void linearize(_Domain t, Workspace& w) const {
+        size_t n = dimension();
+        run_kernel(jacobian_kernel, jacobian_slots, t, w.y.data(),
+                   w.outputs.data(), w);
+        std::copy_n(w.outputs.begin(), n, w.stages.begin());
+        std::fill(w.jacobian.begin(), w.jacobian.end(), _Domain(0));
+        std::fill(w.time_derivative.begin(), w.time_derivative.end(),
+                  _Domain(0));
+        for (size_t k = 0; k < entries.size(); ++k) {
+            _Domain value = w.outputs[n + k];
+            if (entries[k].column == n) {
+                w.time_derivative[entries[k].row] = value;
+            } else {
+                w.jacobian[entries[k].row * n + entries[k].column] = value;
+            }
+        }
+    }
+
+    _Domain error_norm(Workspace& w) const {
+        using std::fabs;
+        _Domain sum = 0;
+        size_t n = dimension();
+        for (size_t i = 0; i < n; ++i) {
+            _Domain scale =
+                options.absolute_tolerance +
+                options.relative_tolerance *
+                    std::max(fabs(w.y[i]), fabs(w.next[i]));
+            _Domain ratio = w.error[i] / scale;
+            sum += ratio * ratio;
+        }
+        return std::sqrt(sum / std::max(n, size_t(1)));
+    }
+
+    _Domain dormand_prince(_Domain t, _Domain h, Workspace& w) const {
+        size_t n = dimension();
+        _Domain* k = w.stages.data();
+        for (size_t s = 1; s < 7; ++s) {
+            _Domain* out = s == 6 ? w.next.data() : w.stage.data();
+            for (size_t i = 0; i < n; ++i) {
+                _Domain sum = 0;
+                for (size_t j = 0; j < s; ++j) {
+                    sum += _Domain(a[s][j]) * k[j * n + i];
+                }
+                out[i] = w.y[i] + h * sum;
+            }
+            rhs(t + _Domain(c[s]) * h, out, k + s * n, w);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            _Domain sum = 0;
+            for (size_t j = 0; j < 7; ++j) {
+                sum += _Domain(e[j]) * k[j * n + i];
+            }
+            w.error[i] = h * sum;
+        }
+        return error_norm(w);
+    }
+
+    _Domain rosenbrock(_Domain t, _Domain h, Workspace& w) const {
+        const _Domain d = 1 / (2 + std::sqrt(_Domain(2)));
+        const _Domain e32 = 6 + std::sqrt(_Domain(2));
+        size_t n = dimension();
+        for (size_t i = 0; i < n * n; ++i) {
+            w.matrix[i] = -h * d * w.jacobian[i];
+        }
+        for (size_t i = 0; i < n; ++i) {
+            w.matrix[i * n + i] += 1;
+        }
+        if (!w.lu.factor(w.matrix.data(), n)) {
+            return std::numeric_limits<_Domain>::infinity();
+        }
+
+        _Domain* f0 = w.stages.data();
+        _Domain* k1 = f0 + n;
+        _Domain* f1 = k1 + n;
+        _Domain* k2 = f1 + n;
+        _Domain* f2 = k2 + n;
+        _Domain* k3 = f2 + n;
+        for (size_t i = 0; i < n; ++i) {
+            k1[i] = f0[i] + h * d * w.time_derivative[i];
+        }
+        w.lu.solve(k1);
+        for (size_t i = 0; i < n; ++i) {
+            w.stage[i] = w.y[i] + h / 2 * k1[i];
+        }
+        rhs(t + h / 2, w.stage.data(), f1, w);
+        for (size_t i = 0; i < n; ++i) {
+            k2[i] = f1[i] - k1[i];
+        }
+        w.lu.solve(k2);
+        for (size_t i = 0; i < n; ++i) {
+            k2[i] += k1[i];
+            w.next[i] = w.y[i] + h * k2[i];
+        }
+        rhs(t + h, w.next.data(), f2, w);
+        for (size_t i = 0; i < n; ++i) {
+            k3[i] = f2[i] - e32 * (k2[i] - f1[i]) - 2 * (k1[i] - f0[i]) +
+                    h * d * w.time_derivative[i];
+        }
+        w.lu.solve(k3);
+        for (size_t i = 0; i < n; ++i) {
+            w.error[i] = h / 6 * (k1[i] - 2 * k2[i] + k3[i]);
+        }
+        return error_norm(w);
+    }
+
+    _Domain initial_step(_Domain t0, _Domain t1, Workspace& w) const {
+        using std::fabs;
+        _Domain span = fabs(t1 - t0);
+        if (options.initial_step > 0) {
+            return std::min(_Domain(options.initial_step), span);
+        }
+        _Domain y_norm = 0;
+        _Domain f_norm = 0;
+        for (size_t i = 0; i < dimension(); ++i) {
+            y_norm = std::max(y_norm, fabs(w.y[i]));
+            f_norm = std::max(f_norm, fabs(w.stages[i]));
+        }
+        _Domain h = y_norm < 1e-5 || f_norm < 1e-5
+                        ? _Domain(1e-6)
+                        : _Domain(0.01) * y_norm / f_norm;
+        return std::min(h, span);
+    }
+
+    OdeResult<_Domain> run(_Domain t0, _Domain t1, Workspace& w) const {
+        using std::fabs;
+        using std::pow;
+        OdeResult<_Domain> result;
+        bool stiff = options.method == OdeMethod::Rosenbrock;
+        _Domain exponent = stiff ? _Domain(-1) / 3 : _Domain(-1) / 5;
+        _Domain direction = t1 >= t0 ? 1 : -1;
+        _Domain t = t0;
+        bool fresh = false;
+        try {
+            rhs(t, w.y.data(), w.stages.data(), w);
+        } catch (const std::runtime_error&) {
+            result.y = w.y;
+            result.t = t;
+            return result;
+        }
+        _Domain h = direction * initial_step(t0, t1, w);
+
+        result.success = true;
+        while (t != t1) {
+            if (result.steps + result.rejected >= options.max_steps) {
+                result.success = false;
+                break;
+            }
+            bool last = fabs(h) >= fabs(t1 - t);
+            if (last) {
+                h = t1 - t;
+            }
+
+            _Domain error;
+            try {
+                if (stiff && !fresh) {
+                    linearize(t, w);
+                    fresh = true;
+                }
+                error = stiff ? rosenbrock(t, h, w) : dormand_prince(t, h, w);
+            } catch (const std::runtime_error&) {
+                error = std::numeric_limits<_Domain>::infinity();
+            }
+            if (!std::isfinite(error)) {
+                error = std::numeric_limits<_Domain>::infinity();
+            }
+
+            _Domain factor = error == 0 ? _Domain(5)
+                                        : std::clamp(_Domain(0.9) *
+                                                         pow(error, exponent),
+                                                     _Domain(0.2), _Domain(5));
+            if (error <= 1) {
+                ++result.steps;
+                t = last ? t1 : t + h;
+                w.y.swap(w.next);
+                if (!stiff) {
+                    std::copy_n(w.stages.begin() + 6 * dimension(),
+                                dimension(), w.stages.begin());
+                }
+                fresh = false;
+            } else {
+                ++result.rejected;
+                factor = std::min(factor, _Domain(1));
+            }
+            h *= factor;
+            if (fabs(h) <= 16 * std::numeric_limits<_Domain>::epsilon() *
+                               std::max(fabs(t), _Domain(1))) {
+                result.success = false;
+                break;
+            }
+        }
+        result.y = w.y;
+        result.t = t;
+        return result;
+    }
+
+    std::vector<std::string> state_names;
+    std::string time_name;
+    std::vector<std::string> parameter_names;
+    OdeOptions options;
+    CompiledExpression<_Domain> rhs_kernel;
+    CompiledExpression<_Domain> jacobian_kernel;
+    std::vector<Entry> entries;
+    std::vector<uint32_t> rhs_slots, jacobian_slots;
+};
+
+};  // namespace symcpp
+
+#endif  // ODE_HPP
@@ -0,0 +1,56 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace symcpp {
+inline size_t default_threads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+template <typename F>
+void parallel_for(size_t count, F&& body, size_t threads = 0) {
+    if (threads == 0) {
+        threads = default_threads();
+    }
+    threads = std::min(threads, count);
+    if (threads <= 1) {
+        if (count > 0) {
+            body(size_t(0), count);
+        }
+        return;
+    }
+
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (size_t t = 0; t < threads; ++t) {
+        size_t begin = count * t / threads;
+        size_t end = count * (t + 1) / threads;
+        workers.emplace_back([&, begin, end] {
+            try {
+                body(begin, end);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+};  // namespace symcpp
+
+#endif  // PARALLEL_HPP
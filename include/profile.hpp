@@ -0,0 +1,181 @@
+#ifndef PROFILE_HPP
+#define PROFILE_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace symcpp {
+namespace profile {
+enum class Counter {
+    NodesCreated,
+    ConstantFolds,
+    Evaluations,
+    Exceptions,
+    Refinements,
+};
+
+inline constexpr size_t counter_count = 5;
+
+inline const char* counter_name(Counter counter) {
+    switch (counter) {
+        case Counter::NodesCreated:
+            return "nodes_created";
+        case Counter::ConstantFolds:
+            return "constant_folds";
+        case Counter::Evaluations:
+            return "evaluations";
+        case Counter::Exceptions:
+            return "exceptions";
+        case Counter::Refinements:
+            return "refinements";
+    }
+    return "unknown";
+}
+
+struct Phase {
+    std::string name;
+    std::chrono::nanoseconds elapsed{0};
+    uint64_t calls = 0;
+};
+
+inline std::atomic<bool> enabled_flag{false};
+inline std::array<std::atomic<uint64_t>, counter_count> counters{};
+inline std::mutex phases_mutex;
+inline std::vector<Phase> phases;
+
+inline bool enabled() {
+    return enabled_flag.load(std::memory_order_relaxed);
+}
+
+inline void enable(bool on = true) {
+    enabled_flag.store(on, std::memory_order_relaxed);
+}
+
+inline void count(Counter counter, uint64_t n = 1) {
+    if (enabled()) {
+        counters[static_cast<size_t>(counter)].fetch_add(
+            n, std::memory_order_relaxed);
+    }
+}
+
+inline uint64_t value(Counter counter) {
+    return counters[static_cast<size_t>(counter)].load(
+        std::memory_order_relaxed);
+}
+
+inline void record(const std::string& name,
+                   std::chrono::nanoseconds elapsed) {
+    std::lock_guard<std::mutex> lock(phases_mutex);
+    for (auto& phase : phases) {
+        if (phase.name == name) {
+            phase.elapsed += elapsed;
+            ++phase.calls;
+            return;
+        }
+    }
+    phases.push_back({name, elapsed, 1});
+}
+
+inline void reset() {
+    for (auto& counter : counters) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+    std::lock_guard<std::mutex> lock(phases_mutex);
+    phases.clear();
+}
+
+class ScopedTimer {
+   public:
+    explicit ScopedTimer(std::string name)
+        : name(std::move(name)), active(enabled()) {
+        if (active) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ~ScopedTimer() {
+        if (active) {
+            record(name, std::chrono::steady_clock::now() - start);
+        }
+    }
+
+   private:
+    std::string name;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+};
+
+template <typename F>
+decltype(auto) timed(const std::string& name, F&& f) {
+    ScopedTimer timer(name);
+    return std::forward<F>(f)();
+}
+
+inline void report(std::ostream& os) {
+    std::lock_guard<std::mutex> lock(phases_mutex);
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    std::chrono::nanoseconds total{0};
+    for (const auto& phase : phases) {
+        total += phase.elapsed;
+    }
+
+    os << std::left << std::setw(16) << "phase" << std::right
+       << std::setw(14) << "time, ms" << std::setw(10) << "share"
+       << std::setw(10) << "calls" << '\n';
+    for (const auto& phase : phases) {
+        double ms = phase.elapsed.count() / 1e6;
+        double share = total.count() ? 100.0 * phase.elapsed.count() /
+                                           static_cast<double>(total.count())
+                                     : 0.0;
+        os << std::left << std::setw(16) << phase.name << std::right
+           << std::fixed << std::setprecision(3) << std::setw(14) << ms
+           << std::setprecision(1) << std::setw(9) << share << '%'
+           << std::setw(10) << phase.calls << '\n';
+    }
+    os << std::left << std::setw(16) << "total" << std::right
+       << std::setprecision(3) << std::setw(14) << total.count() / 1e6
+       << '\n';
+    os.flags(flags);
+    os.precision(precision);
+
+    os << '\n';
+    for (size_t i = 0; i < counter_count; ++i) {
+        os << std::left << std::setw(16)
+           << counter_name(static_cast<Counter>(i)) << std::right
+           << std::setw(14) << counters[i].load(std::memory_order_relaxed)
+           << '\n';
+    }
+}
+
+inline void report_json(std::ostream& os) {
+    std::lock_guard<std::mutex> lock(phases_mutex);
+    os << "{\"phases\": [";
+    for (size_t i = 0; i < phases.size(); ++i) {
+        os << (i ? ", " : "") << "{\"name\": \"" << phases[i].name
+           << "\", \"ns\": " << phases[i].elapsed.count()
+           << ", \"calls\": " << phases[i].calls << '}';
+    }
+    os << "], \"counters\": {";
+    for (size_t i = 0; i < counter_count; ++i) {
+        os << (i ? ", " : "") << '"' << counter_name(static_cast<Counter>(i))
+           << "\": " << counters[i].load(std::memory_order_relaxed);
+    }
+    os << "}}\n";
+}
+
+};  // namespace profile
+};  // namespace symcpp
+
+#endif  // PROFILE_HPP
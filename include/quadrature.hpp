@@ -0,0 +1,277 @@
+#ifndef QUADRATURE_HPP
+#define QUADRATURE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "compiled.hpp"
+#include "expression.hpp"
+#include "parallel.hpp"
+
+namespace symcpp {
+struct QuadratureOptions {
+    double absolute_tolerance = 1e-10;
+    double relative_tolerance = 1e-10;
+    size_t max_segments = 2000;
+    size_t batch_segments = 64;
+    size_t threads = 0;
+};
+
+template <typename _Domain>
+struct Integral {
+    _Domain value{};
+    typename RealPart<_Domain>::type error = 0;
+    size_t evaluations = 0;
+    bool converged = false;
+};
+
+template <typename _Domain = double>
+    requires std::is_floating_point_v<_Domain> ||
+             std::is_same_v<_Domain, std::complex<long double>> ||
+             std::is_same_v<_Domain, Complexes_t>
+class Integrator {
+   public:
+    using Real = typename RealPart<_Domain>::type;
+    static constexpr size_t block_size =
+        CompiledExpression<_Domain>::block_size;
+
+    Integrator(const Expression<_Domain>& integrand,
+               std::vector<std::string> variables,
+               QuadratureOptions options = {})
+        : kernel(integrand),
+          variable_names(std::move(variables)),
+          options(options) {
+        if (variable_names.empty()) {
+            throw std::runtime_error("No integration variables");
+        }
+        slots = kernel.slots(variable_names, parameter_names);
+    }
+
+    const std::vector<std::string>& parameters() const {
+        return parameter_names;
+    }
+
+    Integral<_Domain> integrate(
+        Real lower, Real upper,
+        const std::map<std::string, _Domain>& values = {}) const {
+        return integrate(std::vector<Real>{lower}, std::vector<Real>{upper},
+                         values);
+    }
+
+    Integral<_Domain> integrate(
+        const std::vector<Real>& lower, const std::vector<Real>& upper,
+        const std::map<std::string, _Domain>& values = {}) const {
+        if (lower.size() != variable_names.size() ||
+            upper.size() != variable_names.size()) {
+            throw std::runtime_error("Integration bounds have wrong size");
+        }
+        std::vector<_Domain> point(variable_names.size());
+        for (const auto& name : parameter_names) {
+            auto it = values.find(name);
+            if (it == values.end()) {
+                throw std::runtime_error("Variable not found: " + name);
+            }
+            point.push_back(it->second);
+        }
+        return level(0, lower, upper, point, options.threads);
+    }
+
+   private:
+    struct Segment {
+        Real lower, upper;
+        _Domain value;
+        Real error;
+    };
+
+    static constexpr Real kronrod_nodes[8] = {
+        0.991455371120812639206854697526329L,
+        0.949107912342758524526189684047851L,
+        0.864864423359769072789712788640926L,
+        0.741531185599394439863864773280788L,
+        0.586087235467691130294144845693013L,
+        0.405845151377397166906606412076961L,
+        0.207784955007898467600689403773245L,
+        0.000000000000000000000000000000000L,
+    };
+    static constexpr Real kronrod_weights[8] = {
+        0.022935322010529224963732008058970L,
+        0.063092092629978553290700663189204L,
+        0.104790010322250183839876322541518L,
+        0.140653259715525918745189590510238L,
+        0.169004726639267902826583426598550L,
+        0.190350578064785409913256402421014L,
+        0.204432940075298892414161999234649L,
+        0.209482141084727828012999174891714L,
+    };
+    static constexpr Real gauss_weights[4] = {
+        0.129484966168869693270611432679082L,
+        0.279705391489276667901467771423780L,
+        0.381830050505118944950369775488975L,
+        0.417959183673469387755102040816327L,
+    };
+    static constexpr size_t points = 15;
+
+    Integral<_Domain> level(size_t dimension, const std::vector<Real>& lower,
+                            const std::vector<Real>& upper,
+                            const std::vector<_Domain>& point,
+                            size_t threads) const {
+        if (dimension + 1 == variable_names.size()) {
+            return adaptive(
+                lower[dimension], upper[dimension],
+                [&](const Real* x, size_t n, _Domain* out) {
+                    sample(dimension, point, x, n, out, threads);
+                    return n;
+                });
+        }
+        return adaptive(
+            lower[dimension], upper[dimension],
+            [&](const Real* x, size_t n, _Domain* out) {
+                std::vector<size_t> counts(n);
+                parallel_for(
+                    n,
+                    [&](size_t begin, size_t end) {
+                        std::vector<_Domain> inner = point;
+                        for (size_t i = begin; i < end; ++i) {
+                            inner[dimension] = _Domain(x[i]);
+                            Integral<_Domain> result =
+                                level(dimension + 1, lower, upper, inner, 1);
+                            out[i] = result.value;
+                            counts[i] = result.evaluations;
+                        }
+                    },
+                    threads);
+                size_t total = 0;
+                for (size_t count : counts) {
+                    total += count;
+                }
+                return total;
+            });
+    }
+
+    void sample(size_t dimension, const std::vector<_Domain>& point,
+                const Real* x, size_t n, _Domain* out, size_t threads) const {
+        size_t blocks = (n + block_size - 1) / block_size;
+        parallel_for(
+            blocks,
+            [&](size_t begin, size_t end) {
+                typename CompiledExpression<_Domain>::Workspace workspace;
+                std::vector<std::vector<_Domain>> columns(slots.size());
+                std::vector<const _Domain*> pointers(slots.size());
+                for (size_t block = begin; block < end; ++block) {
+                    size_t offset = block * block_size;
+                    size_t rows = std::min(block_size, n - offset);
+                    for (size_t v = 0; v < slots.size(); ++v) {
+                        columns[v].resize(rows);
+                        for (size_t r = 0; r < rows; ++r) {
+                            columns[v][r] = slots[v] == dimension
+                                                ? _Domain(x[offset + r])
+                                                : point[slots[v]];
+                        }
+                        pointers[v] = columns[v].data();
+                    }
+                    _Domain* results[] = {out + offset};
+                    kernel.eval_batch(pointers.data(), rows, results,
+                                      workspace);
+                }
+            },
+            threads);
+    }
+
+    template <typename F>
+    Integral<_Domain> adaptive(Real lower, Real upper, F&& evaluate) const {
+        using std::abs;
+        Integral<_Domain> result;
+        std::vector<Segment> segments{{lower, upper, _Domain{}, 0}};
+        std::vector<Segment> pending = segments;
+        std::vector<Real> nodes;
+        std::vector<_Domain> samples;
+        segments.clear();
+
+        while (true) {
+            nodes.resize(pending.size() * points);
+            for (size_t s = 0; s < pending.size(); ++s) {
+                Real center = pending[s].lower / 2 + pending[s].upper / 2;
+                Real half = pending[s].upper / 2 - pending[s].lower / 2;
+                Real* x = nodes.data() + s * points;
+                x[0] = center;
+                for (size_t j = 0; j < 7; ++j) {
+                    x[2 * j + 1] = center - half * kronrod_nodes[j];
+                    x[2 * j + 2] = center + half * kronrod_nodes[j];
+                }
+            }
+            samples.resize(nodes.size());
+            result.evaluations +=
+                evaluate(nodes.data(), nodes.size(), samples.data());
+
+            for (size_t s = 0; s < pending.size(); ++s) {
+                const _Domain* f = samples.data() + s * points;
+                Real half = pending[s].upper / 2 - pending[s].lower / 2;
+                _Domain kronrod = f[0] * kronrod_weights[7];
+                _Domain gauss = f[0] * gauss_weights[3];
+                for (size_t j = 0; j < 7; ++j) {
+                    _Domain pair = f[2 * j + 1] + f[2 * j + 2];
+                    kronrod += pair * kronrod_weights[j];
+                    if (j % 2 == 1) {
+                        gauss += pair * gauss_weights[j / 2];
+                    }
+                }
+                pending[s].value = kronrod * half;
+                pending[s].error = abs((kronrod - gauss) * half);
+                segments.push_back(pending[s]);
+            }
+
+            result.value = _Domain{};
+            result.error = 0;
+            for (const auto& segment : segments) {
+                result.value += segment.value;
+                result.error += segment.error;
+            }
+            Real tolerance =
+                std::max(Real(options.absolute_tolerance),
+                         Real(options.relative_tolerance) * abs(result.value));
+            result.converged = result.error <= tolerance;
+            if (result.converged || !std::isfinite(result.error) ||
+                segments.size() >= options.max_segments) {
+                return result;
+            }
+
+            size_t split = std::min(
+                {options.batch_segments, segments.size(),
+                 (options.max_segments - segments.size() + 1) / 2});
+            split = std::max(split, size_t(1));
+            std::partial_sort(segments.begin(), segments.begin() + split,
+                              segments.end(),
+                              [](const Segment& a, const Segment& b) {
+                                  return a.error > b.error;
+                              });
+            while (split > 1 &&
+                   segments[split - 1].error <
+                       tolerance / static_cast<Real>(segments.size())) {
+                --split;
+            }
+            pending.clear();
+            for (size_t s = 0; s < split; ++s) {
+                Real middle = segments[s].lower / 2 + segments[s].upper / 2;
+                pending.push_back({segments[s].lower, middle, _Domain{}, 0});
+                pending.push_back({middle, segments[s].upper, _Domain{}, 0});
+            }
+            segments.erase(segments.begin(), segments.begin() + split);
+        }
+    }
+
+    CompiledExpression<_Domain> kernel;
+    std::vector<std::string> variable_names;
+    std::vector<std::string> parameter_names;
+    std::vector<uint32_t> slots;
+    QuadratureOptions options;
+};
+
+};  // namespace symcpp
+
+#endif  // QUADRATURE_HPP
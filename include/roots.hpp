@@ -0,0 +1,271 @@
+#ifndef ROOTS_HPP
+#define ROOTS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "compiled.hpp"
+#include "expression.hpp"
+#include "parallel.hpp"
+
+namespace symcpp {
+enum class RootStatus : uint8_t {
+    Converged,
+    MaxIterations,
+    NotBracketed,
+    Failed,
+};
+
+inline const char* root_status_name(RootStatus status) {
+    switch (status) {
+        case RootStatus::Converged:
+            return "converged";
+        case RootStatus::MaxIterations:
+            return "max_iterations";
+        case RootStatus::NotBracketed:
+            return "not_bracketed";
+        case RootStatus::Failed:
+            return "failed";
+    }
+    return "unknown";
+}
+
+template <typename _Domain>
+struct Root {
+    _Domain x{};
+    size_t iterations = 0;
+    RootStatus status = RootStatus::Failed;
+};
+
+struct RootOptions {
+    double tolerance = 1e-12;
+    size_t max_iterations = 100;
+    size_t threads = 0;
+};
+
+template <typename _Domain = double>
+    requires std::is_floating_point_v<_Domain>
+class RootFinder {
+   public:
+    static constexpr size_t block_size =
+        CompiledExpression<_Domain>::block_size;
+
+    struct Workspace {
+        std::vector<_Domain> x, f, df, lower, upper, f_lower;
+        std::vector<RootStatus> status;
+        std::vector<uint32_t> iterations;
+        std::vector<uint8_t> bracketed, done;
+        std::vector<const _Domain*> columns;
+        typename CompiledExpression<_Domain>::Workspace kernel;
+    };
+
+    RootFinder(const Expression<_Domain>& f, const std::string& variable,
+               RootOptions options = {})
+        : kernel({f, f.diff(variable)}, {"f", "df/d" + variable}),
+          options(options) {
+        const auto& names = kernel.variables();
+        unknown = std::find(names.begin(), names.end(), variable) -
+                  names.begin();
+        if (unknown == names.size()) {
+            throw std::runtime_error("Variable not found: " + variable);
+        }
+        for (size_t v = 0; v < names.size(); ++v) {
+            if (v != unknown) {
+                parameter_names.push_back(names[v]);
+            }
+        }
+    }
+
+    const std::vector<std::string>& parameters() const {
+        return parameter_names;
+    }
+
+    Root<_Domain> solve(_Domain guess,
+                        const std::map<std::string, _Domain>& values = {},
+                        Workspace* workspace = nullptr) const {
+        return solve(guess, guess, guess, values, workspace);
+    }
+
+    Root<_Domain> solve(_Domain lower, _Domain upper,
+                        const std::map<std::string, _Domain>& values = {},
+                        Workspace* workspace = nullptr) const {
+        return solve(lower, upper, lower / 2 + upper / 2, values, workspace);
+    }
+
+    Root<_Domain> solve(_Domain lower, _Domain upper, _Domain guess,
+                        const std::map<std::string, _Domain>& values,
+                        Workspace* workspace = nullptr) const {
+        Workspace local;
+        Workspace& w = workspace ? *workspace : local;
+        std::vector<_Domain> scalars(parameter_names.size());
+        std::vector<const _Domain*> columns(parameter_names.size());
+        for (size_t p = 0; p < parameter_names.size(); ++p) {
+            auto it = values.find(parameter_names[p]);
+            if (it == values.end()) {
+                throw std::runtime_error("Variable not found: " +
+                                         parameter_names[p]);
+            }
+            scalars[p] = it->second;
+            columns[p] = &scalars[p];
+        }
+        Root<_Domain> root;
+        solve_block(columns.data(), &lower, &upper, &guess, 0, 1, &root.x,
+                    &root.status, &root.iterations, w);
+        return root;
+    }
+
+    void solve_batch(const _Domain* const* parameters, const _Domain* lower,
+                     const _Domain* upper, const _Domain* guess, size_t rows,
+                     _Domain* roots, RootStatus* status,
+                     size_t* iterations = nullptr) const {
+        size_t blocks = (rows + block_size - 1) / block_size;
+        parallel_for(
+            blocks,
+            [&](size_t begin, size_t end) {
+                Workspace workspace;
+                for (size_t block = begin; block < end; ++block) {
+                    size_t offset = block * block_size;
+                    solve_block(parameters, lower, upper, guess, offset,
+                                std::min(block_size, rows - offset), roots,
+                                status, iterations, workspace);
+                }
+            },
+            options.threads);
+    }
+
+   private:
+    void evaluate(size_t offset, size_t n, const _Domain* const* parameters,
+                  const _Domain* x, Workspace& w) const {
+        w.columns.resize(kernel.variables().size());
+        for (size_t v = 0, p = 0; v < w.columns.size(); ++v) {
+            w.columns[v] = v == unknown ? x : parameters[p++] + offset;
+        }
+        _Domain* results[] = {w.f.data(), w.df.data()};
+        kernel.eval_batch_or_nan(w.columns.data(), n, results, w.kernel);
+    }
+
+    void solve_block(const _Domain* const* parameters, const _Domain* lower,
+                     const _Domain* upper, const _Domain* guess, size_t offset,
+                     size_t n, _Domain* roots, RootStatus* status,
+                     size_t* iterations, Workspace& w) const {
+        constexpr _Domain infinity = std::numeric_limits<_Domain>::infinity();
+        w.f.resize(n);
+        w.df.resize(n);
+        w.x.assign(lower + offset, lower + offset + n);
+        evaluate(offset, n, parameters, w.x.data(), w);
+        w.f_lower = w.f;
+        w.x.assign(upper + offset, upper + offset + n);
+        evaluate(offset, n, parameters, w.x.data(), w);
+        w.lower.assign(lower + offset, lower + offset + n);
+        w.upper.assign(upper + offset, upper + offset + n);
+        w.status.assign(n, RootStatus::MaxIterations);
+        w.iterations.assign(n, 0);
+        w.bracketed.assign(n, 0);
+        w.done.assign(n, 0);
+
+        for (size_t r = 0; r < n; ++r) {
+            _Domain a = w.f_lower[r];
+            _Domain b = w.f[r];
+            bool usable = w.lower[r] < w.upper[r] && std::isfinite(a) &&
+                          std::isfinite(b);
+            w.x[r] = guess[offset + r];
+            if (usable && (a == 0 || b == 0)) {
+                w.x[r] = a == 0 ? w.lower[r] : w.upper[r];
+                w.status[r] = RootStatus::Converged;
+                w.done[r] = 1;
+            } else if (usable && (a < 0) != (b < 0)) {
+                w.bracketed[r] = 1;
+                if (a > 0) {
+                    std::swap(w.lower[r], w.upper[r]);
+                }
+            } else if (w.lower[r] != w.upper[r]) {
+                w.status[r] = RootStatus::NotBracketed;
+                w.done[r] = 1;
+            } else {
+                w.lower[r] = -infinity;
+                w.upper[r] = infinity;
+            }
+        }
+
+        size_t active = n - std::count(w.done.begin(), w.done.end(), 1);
+        for (size_t iteration = 0;
+             active > 0 && iteration < options.max_iterations; ++iteration) {
+            evaluate(offset, n, parameters, w.x.data(), w);
+            step(n, w);
+            active = n - std::count(w.done.begin(), w.done.end(), 1);
+        }
+
+        for (size_t r = 0; r < n; ++r) {
+            roots[offset + r] = w.x[r];
+            status[offset + r] = w.status[r];
+            if (iterations) {
+                iterations[offset + r] = w.iterations[r];
+            }
+        }
+    }
+
+    void step(size_t n, Workspace& w) const {
+        const _Domain tolerance = options.tolerance;
+        _Domain* xs = w.x.data();
+        _Domain* lowers = w.lower.data();
+        _Domain* uppers = w.upper.data();
+        const _Domain* fs = w.f.data();
+        const _Domain* dfs = w.df.data();
+        const uint8_t* bracketed = w.bracketed.data();
+        uint8_t* done = w.done.data();
+        uint32_t* counts = w.iterations.data();
+        RootStatus* status = w.status.data();
+        for (size_t r = 0; r < n; ++r) {
+            bool active = !done[r];
+            bool inside = bracketed[r];
+            _Domain x = xs[r];
+            _Domain f = fs[r];
+            bool zero = f == 0;
+            bool finite = f - f == 0;
+            bool negative = f < 0;
+
+            _Domain lower = active && inside && negative ? x : lowers[r];
+            _Domain upper = active && inside && !negative ? x : uppers[r];
+            _Domain low = lower < upper ? lower : upper;
+            _Domain high = lower < upper ? upper : lower;
+            _Domain newton = x - f / dfs[r];
+            bool within = newton > low && newton < high;
+            _Domain next = inside && !within ? low / 2 + high / 2 : newton;
+
+            bool failed =
+                !finite || (!zero && !inside && !(newton - newton == 0));
+            _Domain scale = 1 + (next < 0 ? -next : next);
+            _Domain change = next - x;
+            bool converged =
+                zero || (change < 0 ? -change : change) <= tolerance * scale ||
+                (inside && high - low <= tolerance * scale);
+
+            lowers[r] = lower;
+            uppers[r] = upper;
+            xs[r] = active && !zero && !failed ? next : x;
+            counts[r] += active;
+            status[r] = !active   ? status[r]
+                        : zero    ? RootStatus::Converged
+                        : failed  ? RootStatus::Failed
+                        : converged ? RootStatus::Converged
+                                    : status[r];
+            done[r] = done[r] | (active && (zero || failed || converged));
+        }
+    }
+
+    CompiledExpression<_Domain> kernel;
+    RootOptions options;
+    size_t unknown = 0;
+    std::vector<std::string> parameter_names;
+};
+
+};  // namespace symcpp
+
+#endif  // ROOTS_HPP
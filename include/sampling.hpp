@@ -0,0 +1,253 @@
+#ifndef SAMPLING_HPP
+#define SAMPLING_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "compiled.hpp"
+#include "expression.hpp"
+
+namespace symcpp {
+struct SamplingOptions {
+    size_t initial_points = 65;
+    size_t max_depth = 16;
+    double tolerance = 1e-3;
+    double jump = 0.05;
+    bool compact = true;
+};
+
+template <typename _Domain>
+struct SamplePoint {
+    _Domain x{};
+    _Domain y{};
+    bool valid = false;
+};
+
+template <typename _Domain>
+struct Samples {
+    std::vector<SamplePoint<_Domain>> points;
+    size_t evaluations = 0;
+};
+
+template <typename _Domain = double>
+    requires std::is_floating_point_v<_Domain>
+class AdaptiveSampler {
+   public:
+    AdaptiveSampler(const Expression<_Domain>& expr, std::string variable,
+                    SamplingOptions options = {})
+        : kernel(expr), variable_name(std::move(variable)), options(options) {
+        for (const auto& name : kernel.variables()) {
+            if (name != variable_name) {
+                parameter_names.push_back(name);
+            }
+        }
+    }
+
+    const std::vector<std::string>& parameters() const {
+        return parameter_names;
+    }
+
+    Samples<_Domain> sample(
+        _Domain lower, _Domain upper,
+        const std::map<std::string, _Domain>& values = {}) const {
+        if (!(lower < upper)) {
+            throw std::runtime_error("Sampling range is empty");
+        }
+        State state;
+        for (const auto& name : kernel.variables()) {
+            if (name == variable_name) {
+                state.columns.emplace_back();
+                continue;
+            }
+            auto it = values.find(name);
+            if (it == values.end()) {
+                throw std::runtime_error("Variable not found: " + name);
+            }
+            state.columns.emplace_back(1, it->second);
+        }
+
+        Samples<_Domain> result;
+        size_t count = std::max(options.initial_points, size_t(2));
+        std::vector<_Domain> xs(count);
+        for (size_t i = 0; i < count; ++i) {
+            xs[i] = lower + (upper - lower) * _Domain(i) / _Domain(count - 1);
+        }
+        xs.back() = upper;
+        std::vector<SamplePoint<_Domain>> points = evaluate(xs, state);
+        result.evaluations += count;
+
+        _Domain low = std::numeric_limits<_Domain>::infinity();
+        _Domain high = -low;
+        for (const auto& point : points) {
+            if (point.valid) {
+                low = std::min(low, point.y);
+                high = std::max(high, point.y);
+            }
+        }
+        _Domain range = high > low ? high - low : _Domain(1);
+
+        size_t max_depth = std::min<size_t>(
+            options.max_depth, std::numeric_limits<_Domain>::digits);
+        std::vector<size_t> depth(points.size() - 1, 0), next_depth;
+        std::vector<uint8_t> open(points.size() - 1, 1), next_open;
+        std::vector<SamplePoint<_Domain>> next_points;
+        while (std::find(open.begin(), open.end(), 1) != open.end()) {
+            xs.clear();
+            for (size_t s = 0; s < open.size(); ++s) {
+                if (open[s]) {
+                    xs.push_back(points[s].x / 2 + points[s + 1].x / 2);
+                }
+            }
+            std::vector<SamplePoint<_Domain>> middles = evaluate(xs, state);
+            result.evaluations += xs.size();
+
+            next_points.clear();
+            next_depth.clear();
+            next_open.clear();
+            for (size_t s = 0, m = 0; s < open.size(); ++s) {
+                next_points.push_back(points[s]);
+                if (!open[s]) {
+                    next_depth.push_back(depth[s]);
+                    next_open.push_back(0);
+                    continue;
+                }
+                const auto& a = points[s];
+                const auto& b = points[s + 1];
+                const auto& middle = middles[m++];
+                if (!(a.x < middle.x && middle.x < b.x)) {
+                    next_depth.push_back(depth[s]);
+                    next_open.push_back(0);
+                    continue;
+                }
+                bool refine = needs_refinement(a, middle, b, range);
+                bool deeper = refine && depth[s] + 1 < max_depth;
+                if (refine && !deeper && a.valid && b.valid &&
+                    middle.valid) {
+                    bool left = std::fabs(middle.y - a.y) >
+                                std::fabs(b.y - middle.y);
+                    const auto& from = left ? a : middle;
+                    const auto& to = left ? middle : b;
+                    _Domain step = std::fabs(to.y - from.y);
+                    if (step > options.jump * range &&
+                        step > _Domain(0.9) * std::fabs(b.y - a.y)) {
+                        SamplePoint<_Domain> gap{
+                            from.x / 2 + to.x / 2,
+                            std::numeric_limits<_Domain>::quiet_NaN(), false};
+                        if (left) {
+                            next_points.push_back(gap);
+                        }
+                        next_points.push_back(middle);
+                        if (!left) {
+                            next_points.push_back(gap);
+                        }
+                        next_depth.insert(next_depth.end(), 3, depth[s] + 1);
+                        next_open.insert(next_open.end(), 3, 0);
+                        continue;
+                    }
+                }
+                next_points.push_back(middle);
+                next_depth.insert(next_depth.end(), 2, depth[s] + 1);
+                next_open.insert(next_open.end(), 2, deeper ? 1 : 0);
+            }
+            next_points.push_back(points.back());
+            points.swap(next_points);
+            depth.swap(next_depth);
+            open.swap(next_open);
+        }
+
+        result.points =
+            options.compact ? compact(points, range) : points;
+        return result;
+    }
+
+   private:
+    struct State {
+        std::vector<std::vector<_Domain>> columns;
+        std::vector<const _Domain*> pointers;
+        std::vector<_Domain> results;
+        typename CompiledExpression<_Domain>::Workspace workspace;
+    };
+
+    std::vector<SamplePoint<_Domain>> evaluate(const std::vector<_Domain>& xs,
+                                               State& state) const {
+        size_t n = xs.size();
+        state.pointers.resize(state.columns.size());
+        for (size_t v = 0; v < state.columns.size(); ++v) {
+            auto& column = state.columns[v];
+            if (kernel.variables()[v] == variable_name) {
+                column = xs;
+            } else {
+                column.resize(std::max(n, size_t(1)), column[0]);
+            }
+            state.pointers[v] = column.data();
+        }
+        state.results.resize(n);
+        _Domain* results[] = {state.results.data()};
+        kernel.eval_batch_or_nan(state.pointers.data(), n, results,
+                                 state.workspace);
+
+        std::vector<SamplePoint<_Domain>> points(n);
+        for (size_t r = 0; r < n; ++r) {
+            points[r] = {xs[r], state.results[r],
+                         static_cast<bool>(std::isfinite(state.results[r]))};
+        }
+        return points;
+    }
+
+    bool needs_refinement(const SamplePoint<_Domain>& a,
+                          const SamplePoint<_Domain>& middle,
+                          const SamplePoint<_Domain>& b,
+                          _Domain range) const {
+        if (!a.valid && !b.valid) {
+            return middle.valid;
+        }
+        if (!a.valid || !b.valid || !middle.valid) {
+            return true;
+        }
+        _Domain chord = a.y / 2 + b.y / 2;
+        return std::fabs(middle.y - chord) > options.tolerance * range;
+    }
+
+    std::vector<SamplePoint<_Domain>> compact(
+        const std::vector<SamplePoint<_Domain>>& points,
+        _Domain range) const {
+        constexpr size_t window = 64;
+        std::vector<SamplePoint<_Domain>> result;
+        size_t anchor = 0;
+        result.push_back(points[0]);
+        for (size_t i = 1; i + 1 < points.size(); ++i) {
+            const auto& a = points[anchor];
+            const auto& c = points[i + 1];
+            bool skip = a.valid && points[i].valid && c.valid &&
+                        i + 1 - anchor <= window;
+            for (size_t j = anchor + 1; skip && j <= i; ++j) {
+                _Domain t = (points[j].x - a.x) / (c.x - a.x);
+                _Domain line = a.y + t * (c.y - a.y);
+                skip = std::fabs(points[j].y - line) <=
+                       options.tolerance * range / 2;
+            }
+            if (!skip) {
+                result.push_back(points[i]);
+                anchor = i;
+            }
+        }
+        result.push_back(points.back());
+        return result;
+    }
+
+    CompiledExpression<_Domain> kernel;
+    std::string variable_name;
+    std::vector<std::string> parameter_names;
+    SamplingOptions options;
+};
+
+};  // namespace symcpp
+
+#endif  // SAMPLING_HPP
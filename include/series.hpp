@@ -0,0 +1,249 @@
+#ifndef SERIES_HPP
+#define SERIES_HPP
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "expression.hpp"
+
+namespace symcpp {
+namespace detail {
+template <Numeric _Domain>
+class SeriesExpansion {
+   public:
+    using Series = std::vector<Expression<_Domain>>;
+
+    SeriesExpansion(const std::string& variable, _Domain point, size_t terms)
+        : variable(variable), point(point), terms(terms) {}
+
+    const Series& expand(const Expression<_Domain>& expr) {
+        auto known = memo.find(expr.id());
+        if (known != memo.end()) {
+            return known->second;
+        }
+        Series result = compute(expr);
+        return memo.emplace(expr.id(), std::move(result)).first->second;
+    }
+
+    size_t shifted() const { return shift_total; }
+
+   private:
+    static bool is_zero(const Expression<_Domain>& expr) {
+        return expr.kind() == NodeKind::Value && expr.value() == _Domain(0);
+    }
+
+    Series constant(const Expression<_Domain>& value) const {
+        Series result(terms, Expression<_Domain>(0));
+        result[0] = value;
+        return result;
+    }
+
+    Series compute(const Expression<_Domain>& expr) {
+        switch (expr.kind()) {
+            case NodeKind::Value:
+                return constant(expr);
+            case NodeKind::Variable: {
+                if (expr.name() != variable) {
+                    return constant(expr);
+                }
+                Series result = constant(Expression<_Domain>(point));
+                if (terms > 1) {
+                    result[1] = Expression<_Domain>(1);
+                }
+                return result;
+            }
+            case NodeKind::Add:
+            case NodeKind::Subtract: {
+                Series a = expand(expr.operand(0));
+                const Series& b = expand(expr.operand(1));
+                for (size_t k = 0; k < terms; ++k) {
+                    a[k] = expr.kind() == NodeKind::Add ? a[k] + b[k]
+                                                        : a[k] - b[k];
+                }
+                return a;
+            }
+            case NodeKind::Multiply:
+                return multiply(expand(expr.operand(0)),
+                                expand(expr.operand(1)));
+            case NodeKind::Divide:
+                return divide(expand(expr.operand(0)),
+                              expand(expr.operand(1)));
+            case NodeKind::Power:
+                return power(expand(expr.operand(0)),
+                             expand(expr.operand(1)));
+            case NodeKind::Sin:
+            case NodeKind::Cos: {
+                auto [sine, cosine] = sin_cos(expand(expr.operand(0)));
+                return expr.kind() == NodeKind::Sin ? sine : cosine;
+            }
+            case NodeKind::Ln:
+                return log(expand(expr.operand(0)));
+            case NodeKind::Exp:
+                return exp(expand(expr.operand(0)));
+        }
+        throw std::runtime_error("Unknown node kind");
+    }
+
+    Series multiply(const Series& a, const Series& b) const {
+        Series result(terms, Expression<_Domain>(0));
+        for (size_t k = 0; k < terms; ++k) {
+            for (size_t j = 0; j <= k; ++j) {
+                result[k] = result[k] + a[j] * b[k - j];
+            }
+        }
+        return result;
+    }
+
+    Series divide(Series a, Series b) {
+        size_t shift = 0;
+        while (shift < terms && is_zero(a[shift]) && is_zero(b[shift])) {
+            ++shift;
+        }
+        if (shift == terms) {
+            throw std::runtime_error("Series expansion is singular");
+        }
+        if (shift > 0) {
+            shift_total += shift;
+            a.erase(a.begin(), a.begin() + shift);
+            b.erase(b.begin(), b.begin() + shift);
+            a.resize(terms, Expression<_Domain>(0));
+            b.resize(terms, Expression<_Domain>(0));
+        }
+        Series result(terms);
+        for (size_t k = 0; k < terms; ++k) {
+            Expression<_Domain> numerator = a[k];
+            for (size_t j = 1; j <= k; ++j) {
+                numerator = numerator - b[j] * result[k - j];
+            }
+            result[k] = numerator / b[0];
+        }
+        return result;
+    }
+
+    Series exp(const Series& a) const {
+        Series result(terms);
+        result[0] = a[0].exp();
+        for (size_t k = 1; k < terms; ++k) {
+            Expression<_Domain> sum(0);
+            for (size_t j = 1; j <= k; ++j) {
+                sum = sum + _Domain(j) * a[j] * result[k - j];
+            }
+            result[k] = sum / _Domain(k);
+        }
+        return result;
+    }
+
+    Series log(const Series& a) const {
+        if (is_zero(a[0])) {
+            throw std::runtime_error("Ln domain error");
+        }
+        Series result(terms);
+        result[0] = a[0].ln();
+        for (size_t k = 1; k < terms; ++k) {
+            Expression<_Domain> sum(0);
+            for (size_t j = 1; j < k; ++j) {
+                sum = sum + _Domain(j) * result[j] * a[k - j];
+            }
+            result[k] = (a[k] - sum / _Domain(k)) / a[0];
+        }
+        return result;
+    }
+
+    std::pair<Series, Series> sin_cos(const Series& a) const {
+        Series sine(terms);
+        Series cosine(terms);
+        sine[0] = a[0].sin();
+        cosine[0] = a[0].cos();
+        for (size_t k = 1; k < terms; ++k) {
+            Expression<_Domain> s(0);
+            Expression<_Domain> c(0);
+            for (size_t j = 1; j <= k; ++j) {
+                s = s + _Domain(j) * a[j] * cosine[k - j];
+                c = c + _Domain(j) * a[j] * sine[k - j];
+            }
+            sine[k] = s / _Domain(k);
+            cosine[k] = _Domain(-1) * c / _Domain(k);
+        }
+        return {sine, cosine};
+    }
+
+    Series power(const Series& a, const Series& b) const {
+        bool constant_exponent = b[0].kind() == NodeKind::Value;
+        for (size_t k = 1; k < terms; ++k) {
+            constant_exponent &= is_zero(b[k]);
+        }
+        if (!constant_exponent) {
+            Series logarithm = log(a);
+            return exp(multiply(b, logarithm));
+        }
+
+        _Domain exponent = b[0].value();
+        if constexpr (requires { std::trunc(exponent); }) {
+            if (exponent >= 0 && exponent == std::trunc(exponent) &&
+                exponent <= 64) {
+                Series result = constant(Expression<_Domain>(1));
+                Series base = a;
+                for (auto n = static_cast<unsigned>(exponent); n > 0;
+                     n >>= 1) {
+                    if (n & 1) {
+                        result = multiply(result, base);
+                    }
+                    if (n > 1) {
+                        base = multiply(base, base);
+                    }
+                }
+                return result;
+            }
+        }
+        if (is_zero(a[0])) {
+            throw std::runtime_error("Series expansion is singular");
+        }
+        Series result(terms);
+        result[0] = a[0].pow(b[0]);
+        for (size_t k = 1; k < terms; ++k) {
+            Expression<_Domain> sum(0);
+            for (size_t j = 1; j <= k; ++j) {
+                sum = sum + (exponent * _Domain(j) - _Domain(k - j)) * a[j] *
+                                result[k - j];
+            }
+            result[k] = sum / (_Domain(k) * a[0]);
+        }
+        return result;
+    }
+
+    std::string variable;
+    _Domain point;
+    size_t terms;
+    size_t shift_total = 0;
+    std::unordered_map<const void*, Series> memo;
+};
+};  // namespace detail
+
+template <Numeric _Domain>
+Expression<_Domain> series(const Expression<_Domain>& expr,
+                           const std::string& variable, _Domain point,
+                           size_t order) {
+    for (size_t guard = 4;;) {
+        detail::SeriesExpansion<_Domain> expansion(variable, point,
+                                                   order + 1 + guard);
+        const auto& coefficients = expansion.expand(expr);
+        if (expansion.shifted() > guard) {
+            guard = expansion.shifted();
+            continue;
+        }
+        Expression<_Domain> offset =
+            Expression<_Domain>(variable) - Expression<_Domain>(point);
+        Expression<_Domain> result = coefficients[order];
+        for (size_t k = order; k-- > 0;) {
+            result = coefficients[k] + offset * result;
+        }
+        return result;
+    }
+}
+
+};  // namespace symcpp
+
+#endif  // SERIES_HPP
@@ -0,0 +1,369 @@
+#ifndef SYSTEMS_HPP
+#define SYSTEMS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "banded.hpp"
+#include "compiled.hpp"
+#include "dense.hpp"
+#include "expression.hpp"
+#include "roots.hpp"
+
+namespace symcpp {
+struct SystemOptions {
+    double tolerance = 1e-10;
+    double step_tolerance = 1e-14;
+    size_t max_iterations = 100;
+    bool broyden = true;
+    size_t max_updates = 20;
+};
+
+template <typename _Domain>
+struct SystemSolution {
+    std::vector<_Domain> x;
+    _Domain residual{};
+    size_t iterations = 0;
+    size_t jacobian_evaluations = 0;
+    RootStatus status = RootStatus::Failed;
+};
+
+template <typename _Domain = double>
+    requires std::is_floating_point_v<_Domain>
+class SystemSolver {
+   public:
+    struct Entry {
+        uint32_t row, column;
+    };
+
+    struct Workspace {
+        std::vector<_Domain> point, inputs, outputs;
+        std::vector<_Domain> residual, trial_point, trial, step, scratch;
+        std::vector<_Domain> normal, left, right;
+        size_t updates = 0;
+        BandedLuFactorization<_Domain> lu;
+        typename CompiledExpression<_Domain>::Workspace kernel;
+    };
+
+    SystemSolver(const std::vector<Expression<_Domain>>& residuals,
+                 std::vector<std::string> unknowns, SystemOptions options = {})
+        : unknown_names(std::move(unknowns)),
+          options(options),
+          residual_kernel(residuals) {
+        if (residuals.size() < unknown_names.size()) {
+            throw std::runtime_error("System is underdetermined");
+        }
+        std::vector<Expression<_Domain>> outputs = residuals;
+        for (size_t i = 0; i < residuals.size(); ++i) {
+            auto partials = residuals[i].gradient(unknown_names);
+            for (size_t j = 0; j < unknown_names.size(); ++j) {
+                const Expression<_Domain>& derivative = partials[j];
+                if (derivative.kind() == NodeKind::Value &&
+                    derivative.value() == 0) {
+                    continue;
+                }
+                entries.push_back(
+                    {static_cast<uint32_t>(i), static_cast<uint32_t>(j)});
+                outputs.push_back(derivative);
+            }
+        }
+        jacobian_kernel = CompiledExpression<_Domain>(outputs);
+        row_starts.assign(residuals.size() + 1, 0);
+        for (const auto& entry : entries) {
+            ++row_starts[entry.row + 1];
+            columns.push_back(entry.column);
+        }
+        for (size_t i = 0; i < residuals.size(); ++i) {
+            row_starts[i + 1] += row_starts[i];
+        }
+        if (residuals.size() == unknown_names.size()) {
+            pattern = BandedPattern(unknown_names.size(), row_starts, columns);
+        }
+
+        residual_slots =
+            residual_kernel.slots(unknown_names, parameter_names);
+        jacobian_slots =
+            jacobian_kernel.slots(unknown_names, parameter_names);
+    }
+
+    size_t equations() const { return residual_kernel.outputs().size(); }
+    size_t unknowns() const { return unknown_names.size(); }
+    const std::vector<std::string>& parameters() const {
+        return parameter_names;
+    }
+    const std::vector<Entry>& sparsity() const { return entries; }
+
+    SystemSolution<_Domain> solve(
+        const std::vector<_Domain>& guess,
+        const std::map<std::string, _Domain>& values = {},
+        Workspace* workspace = nullptr) const {
+        if (guess.size() != unknowns()) {
+            throw std::runtime_error("Initial guess has wrong size");
+        }
+        Workspace local;
+        Workspace& w = workspace ? *workspace : local;
+        size_t n = unknowns();
+        size_t m = equations();
+        w.point = guess;
+        for (const auto& name : parameter_names) {
+            auto it = values.find(name);
+            if (it == values.end()) {
+                throw std::runtime_error("Variable not found: " + name);
+            }
+            w.point.push_back(it->second);
+        }
+        w.trial_point = w.point;
+        w.residual.resize(m);
+        w.trial.resize(m);
+        w.step.resize(n);
+        w.scratch.resize(std::max(n, m));
+        w.updates = 0;
+
+        SystemSolution<_Domain> solution;
+        solution.status = RootStatus::MaxIterations;
+        if (!residual(w.point, w.residual, w)) {
+            solution.status = RootStatus::Failed;
+        }
+        bool square = m == n;
+        bool factored = false;
+        bool fresh = false;
+        _Domain lambda = 1e-3;
+        while (solution.status == RootStatus::MaxIterations) {
+            solution.residual = max_norm(w.residual);
+            if (solution.residual <= options.tolerance) {
+                solution.status = RootStatus::Converged;
+                break;
+            }
+            if (solution.iterations == options.max_iterations) {
+                break;
+            }
+            ++solution.iterations;
+
+            if (!factored || !square) {
+                if (!jacobian(w.point, w)) {
+                    solution.status = RootStatus::Failed;
+                    break;
+                }
+                ++solution.jacobian_evaluations;
+                fresh = true;
+                w.updates = 0;
+                factored = square && w.lu.factor(pattern, row_starts.data(),
+                                                 columns.data(),
+                                                 w.outputs.data() + m);
+            }
+
+            if (factored) {
+                for (size_t i = 0; i < n; ++i) {
+                    w.step[i] = -w.residual[i];
+                }
+                apply_inverse(w.step.data(), w);
+                if (attempt(w) && squares(w.trial) < squares(w.residual)) {
+                    factored = options.broyden &&
+                               w.updates < options.max_updates &&
+                               broyden_update(w);
+                    fresh = false;
+                    w.point.swap(w.trial_point);
+                    w.residual.swap(w.trial);
+                    continue;
+                }
+                if (!fresh) {
+                    factored = false;
+                    continue;
+                }
+            }
+
+            if (!levenberg_marquardt(lambda, w)) {
+                solution.status = RootStatus::Failed;
+                break;
+            }
+            factored = false;
+            if (!square &&
+                max_norm(w.step) <=
+                    options.step_tolerance * (1 + max_norm(w.point, n))) {
+                solution.residual = max_norm(w.residual);
+                solution.status = RootStatus::Converged;
+            }
+        }
+        solution.x.assign(w.point.begin(), w.point.begin() + n);
+        return solution;
+    }
+
+   private:
+    static _Domain max_norm(const std::vector<_Domain>& values,
+                            size_t count = SIZE_MAX) {
+        using std::fabs;
+        _Domain norm = 0;
+        count = std::min(count, values.size());
+        for (size_t i = 0; i < count; ++i) {
+            norm = std::max(norm, fabs(values[i]));
+        }
+        return norm;
+    }
+
+    static _Domain squares(const std::vector<_Domain>& values) {
+        _Domain sum = 0;
+        for (_Domain value : values) {
+            sum += value * value;
+        }
+        return sum;
+    }
+
+    bool run(const CompiledExpression<_Domain>& kernel,
+             const std::vector<uint32_t>& slot,
+             const std::vector<_Domain>& point, _Domain* results,
+             Workspace& w) const {
+        w.inputs.resize(slot.size());
+        for (size_t v = 0; v < slot.size(); ++v) {
+            w.inputs[v] = point[slot[v]];
+        }
+        try {
+            kernel.eval(w.inputs.data(), results, w.kernel);
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+        for (size_t k = 0; k < kernel.outputs().size(); ++k) {
+            if (!std::isfinite(results[k])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool residual(const std::vector<_Domain>& point,
+                  std::vector<_Domain>& result, Workspace& w) const {
+        return run(residual_kernel, residual_slots, point, result.data(), w);
+    }
+
+    bool jacobian(const std::vector<_Domain>& point, Workspace& w) const {
+        size_t m = equations();
+        w.outputs.resize(m + entries.size());
+        if (!run(jacobian_kernel, jacobian_slots, point, w.outputs.data(),
+                 w)) {
+            return false;
+        }
+        std::copy_n(w.outputs.begin(), m, w.residual.begin());
+        return true;
+    }
+
+    bool attempt(Workspace& w) const {
+        size_t n = unknowns();
+        for (size_t i = 0; i < n; ++i) {
+            w.trial_point[i] = w.point[i] + w.step[i];
+        }
+        return residual(w.trial_point, w.trial, w);
+    }
+
+    void apply_inverse(_Domain* x, Workspace& w) const {
+        size_t n = unknowns();
+        std::copy_n(x, n, w.scratch.begin());
+        w.lu.solve(x);
+        for (size_t k = 0; k < w.updates; ++k) {
+            const _Domain* right = w.right.data() + k * n;
+            const _Domain* left = w.left.data() + k * n;
+            _Domain dot = 0;
+            for (size_t i = 0; i < n; ++i) {
+                dot += right[i] * w.scratch[i];
+            }
+            for (size_t i = 0; i < n; ++i) {
+                x[i] += left[i] * dot;
+            }
+        }
+    }
+
+    void apply_inverse_transposed(_Domain* x, Workspace& w) const {
+        size_t n = unknowns();
+        std::copy_n(x, n, w.scratch.begin());
+        w.lu.solve_transposed(x);
+        for (size_t k = 0; k < w.updates; ++k) {
+            const _Domain* right = w.right.data() + k * n;
+            const _Domain* left = w.left.data() + k * n;
+            _Domain dot = 0;
+            for (size_t i = 0; i < n; ++i) {
+                dot += left[i] * w.scratch[i];
+            }
+            for (size_t i = 0; i < n; ++i) {
+                x[i] += right[i] * dot;
+            }
+        }
+    }
+
+    bool broyden_update(Workspace& w) const {
+        using std::fabs;
+        size_t n = unknowns();
+        w.left.resize((w.updates + 1) * n);
+        w.right.resize((w.updates + 1) * n);
+        _Domain* left = w.left.data() + w.updates * n;
+        _Domain* right = w.right.data() + w.updates * n;
+        for (size_t i = 0; i < n; ++i) {
+            left[i] = w.trial[i] - w.residual[i];
+            right[i] = w.step[i];
+        }
+        apply_inverse(left, w);
+        apply_inverse_transposed(right, w);
+        _Domain denominator = 0;
+        for (size_t i = 0; i < n; ++i) {
+            denominator += right[i] * (w.trial[i] - w.residual[i]);
+        }
+        if (!(fabs(denominator) > 0) || !std::isfinite(denominator)) {
+            return false;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            left[i] = (w.step[i] - left[i]) / denominator;
+        }
+        ++w.updates;
+        return true;
+    }
+
+    bool levenberg_marquardt(_Domain& lambda, Workspace& w) const {
+        size_t m = equations();
+        size_t n = unknowns();
+        const _Domain* values = w.outputs.data() + m;
+        _Domain cost = squares(w.residual);
+        for (size_t attempt_count = 0; attempt_count < 30; ++attempt_count) {
+            w.normal.assign(n * n, _Domain(0));
+            std::fill(w.step.begin(), w.step.end(), _Domain(0));
+            for (size_t i = 0; i < m; ++i) {
+                for (size_t k = row_starts[i]; k < row_starts[i + 1]; ++k) {
+                    _Domain* normal = w.normal.data() + columns[k] * n;
+                    for (size_t l = row_starts[i]; l <= k; ++l) {
+                        normal[columns[l]] += values[k] * values[l];
+                    }
+                    w.step[columns[k]] -= values[k] * w.residual[i];
+                }
+            }
+            for (size_t j = 0; j < n; ++j) {
+                _Domain& diagonal = w.normal[j * n + j];
+                diagonal += lambda * std::max(diagonal, _Domain(1e-12));
+            }
+            bool solved = cholesky_solve(w.normal, n, w.step.data());
+            if (solved && attempt(w) && squares(w.trial) < cost) {
+                lambda = std::max(lambda / 3, _Domain(1e-12));
+                w.point.swap(w.trial_point);
+                w.residual.swap(w.trial);
+                return true;
+            }
+            lambda *= 4;
+        }
+        return false;
+    }
+
+    std::vector<std::string> unknown_names;
+    std::vector<std::string> parameter_names;
+    SystemOptions options;
+    CompiledExpression<_Domain> residual_kernel;
+    CompiledExpression<_Domain> jacobian_kernel;
+    std::vector<Entry> entries;
+    std::vector<uint32_t> row_starts, columns;
+    BandedPattern pattern;
+    std::vector<uint32_t> residual_slots, jacobian_slots;
+};
+
+};  // namespace symcpp
+
+#endif  // SYSTEMS_HPP
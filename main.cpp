@@ -1,23 +1,38 @@
+#include <algorithm>
 #include <cxxopts.hpp>
+#include <fstream>
 #include <iostream>
 #include <map>
 #include <string>
+#include <type_traits>
+#include <vector>
 
+#include "binary_io.hpp"
+#include "compiled.hpp"
+#include "complex_batch.hpp"
+#include "domain.hpp"
 #include "expression.hpp"
+#include "mixed_precision.hpp"
+#include "profile.hpp"
 
-bool contains_imaginary_unit(const std::string& str) {
-    return str.find('i') != std::string::npos;
+bool is_imaginary_literal(const std::string& str) {
+    return !str.empty() && str.back() == 'i';
 }
 
 symcpp::Complexes_t parse_complex(const std::string& str) {
-    size_t i_pos = str.find('i');
-    if (i_pos == std::string::npos) {
+    if (!is_imaginary_literal(str)) {
         return symcpp::Complexes_t(std::stod(str), 0.0);
     }
 
+    size_t i_pos = str.size() - 1;
     std::string real_part, imag_part;
-    size_t sign_pos = str.find_last_of("+-", i_pos - 1);
-    if (sign_pos == std::string::npos) {
+    size_t sign_pos =
+        i_pos == 0 ? std::string::npos : str.find_last_of("+-", i_pos - 1);
+    if (sign_pos != std::string::npos && sign_pos > 0 &&
+        (str[sign_pos - 1] == 'e' || str[sign_pos - 1] == 'E')) {
+        sign_pos = str.find_last_of("+-", sign_pos - 1);
+    }
+    if (sign_pos == std::string::npos || sign_pos == 0) {
         imag_part = str.substr(0, i_pos);
     } else {
         real_part = str.substr(0, sign_pos);
@@ -32,6 +47,457 @@ symcpp::Complexes_t parse_complex(const std::string& str) {
     return symcpp::Complexes_t(real, imag);
 }
 
+template <typename _Domain>
+using binary_column_t =
+    std::conditional_t<std::is_same_v<_Domain, symcpp::Complexes_t>,
+                       symcpp::Complex128_t, symcpp::Float64_t>;
+
+std::map<std::string, symcpp::Complexes_t> parse_variables(
+    const std::vector<std::string>& assignments) {
+    std::map<std::string, symcpp::Complexes_t> variables;
+    for (const auto& arg : assignments) {
+        size_t eq_pos = arg.find('=');
+        if (eq_pos != std::string::npos) {
+            std::string var_name = arg.substr(0, eq_pos);
+            variables[var_name] = parse_complex(arg.substr(eq_pos + 1));
+        }
+    }
+    return variables;
+}
+
+template <typename _Domain>
+std::map<std::string, _Domain> domain_variables(
+    const std::map<std::string, symcpp::Complexes_t>& values) {
+    std::map<std::string, _Domain> variables;
+    for (const auto& [name, value] : values) {
+        if constexpr (std::is_same_v<_Domain, symcpp::Complexes_t>) {
+            variables[name] = value;
+        } else {
+            variables[name] = value.real();
+        }
+    }
+    return variables;
+}
+
+struct BatchOptions {
+    bool split_complex = false;
+    bool limited_range = false;
+    double mixed_tolerance = 0;
+};
+
+std::vector<std::string> split_list(const std::string& str) {
+    std::vector<std::string> items;
+    size_t start = 0;
+    while (start <= str.size()) {
+        size_t end = str.find(',', start);
+        if (end == std::string::npos) {
+            end = str.size();
+        }
+        if (end > start) {
+            items.push_back(str.substr(start, end - start));
+        }
+        start = end + 1;
+    }
+    return items;
+}
+
+template <typename _Domain>
+void evaluate_binary(const symcpp::CompiledExpression<_Domain>& compiled,
+                     std::map<std::string, _Domain> variables,
+                     const std::vector<std::string>& inputs,
+                     const std::string& output, const BatchOptions& batch) {
+    using Column = binary_column_t<_Domain>;
+    constexpr size_t block = symcpp::CompiledExpression<_Domain>::block_size;
+    constexpr bool zero_copy = std::is_same_v<Column, _Domain>;
+
+    symcpp::profile::ScopedTimer timer("eval");
+
+    std::map<std::string, symcpp::MappedArray<Column>> columns;
+    for (const auto& input : inputs) {
+        size_t eq_pos = input.find('=');
+        if (eq_pos == std::string::npos) {
+            throw std::runtime_error("Expected NAME=PATH, got: " + input);
+        }
+        std::string name = input.substr(0, eq_pos);
+        symcpp::MappedArray<Column> column(input.substr(eq_pos + 1));
+        if (!columns.empty() &&
+            column.size() != columns.begin()->second.size()) {
+            throw std::runtime_error("Input columns differ in length: " +
+                                     input);
+        }
+        variables[name] = _Domain{};
+        columns.insert_or_assign(name, std::move(column));
+    }
+
+    const auto& names = compiled.variables();
+    std::vector<_Domain> scalars = compiled.bind(variables);
+    std::vector<std::vector<_Domain>> buffers(names.size());
+    std::vector<const _Domain*> bound(names.size());
+    std::vector<const symcpp::MappedArray<Column>*> sources(names.size());
+    for (size_t v = 0; v < names.size(); ++v) {
+        auto it = columns.find(names[v]);
+        if (it != columns.end()) {
+            sources[v] = &it->second;
+            buffers[v].resize(zero_copy ? 0 : block);
+        } else {
+            buffers[v].assign(block, scalars[v]);
+        }
+        bound[v] = buffers[v].data();
+    }
+
+    size_t outputs = compiled.outputs().size();
+    size_t rows = columns.empty() ? 1 : columns.begin()->second.size();
+    symcpp::MappedArray<Column> results;
+    if (!output.empty()) {
+        results = symcpp::MappedArray<Column>(output, rows * outputs);
+    }
+
+    typename symcpp::CompiledExpression<_Domain>::Workspace workspace;
+    std::vector<std::vector<_Domain>> values(outputs,
+                                             std::vector<_Domain>(block));
+    std::vector<_Domain*> targets;
+    for (auto& value : values) {
+        targets.push_back(value.data());
+    }
+    bool direct_output = zero_copy && outputs == 1 && !output.empty();
+
+    symcpp::MixedPrecisionEvaluator mixed;
+    symcpp::MixedPrecisionEvaluator::Workspace mixed_workspace;
+    if constexpr (std::is_same_v<_Domain, double>) {
+        if (batch.mixed_tolerance > 0) {
+            mixed = symcpp::MixedPrecisionEvaluator(compiled,
+                                                    batch.mixed_tolerance);
+        }
+    }
+    auto eval_block = [&](size_t n) {
+        if constexpr (std::is_same_v<_Domain, double>) {
+            if (batch.mixed_tolerance > 0) {
+                mixed.eval_batch(bound.data(), n, targets.data(),
+                                 mixed_workspace);
+                return;
+            }
+        }
+        compiled.eval_batch(bound.data(), n, targets.data(), workspace);
+    };
+
+    for (size_t offset = 0; offset < rows; offset += block) {
+        size_t n = std::min(block, rows - offset);
+        for (size_t v = 0; v < names.size(); ++v) {
+            if (!sources[v]) {
+                continue;
+            }
+            if constexpr (zero_copy) {
+                bound[v] = sources[v]->data() + offset;
+            } else {
+                for (size_t r = 0; r < n; ++r) {
+                    buffers[v][r] = _Domain((*sources[v])[offset + r]);
+                }
+            }
+        }
+        if constexpr (zero_copy) {
+            if (direct_output) {
+                targets[0] = results.data() + offset;
+                eval_block(n);
+                continue;
+            }
+        }
+        eval_block(n);
+
+        for (size_t r = 0; r < n; ++r) {
+            for (size_t k = 0; k < outputs; ++k) {
+                const _Domain& value = values[k][r];
+                size_t index = (offset + r) * outputs + k;
+                if (output.empty()) {
+                    std::cout << value << (k + 1 < outputs ? ' ' : '\n');
+                } else if constexpr (std::is_same_v<_Domain,
+                                                    symcpp::Complexes_t>) {
+                    results[index] = Column(value.real(), value.imag());
+                } else {
+                    results[index] = Column(value);
+                }
+            }
+        }
+    }
+}
+
+void evaluate_split(
+    const symcpp::CompiledExpression<symcpp::Complexes_t>& compiled,
+    std::map<std::string, symcpp::Complexes_t> variables,
+    const std::vector<std::string>& inputs, const std::string& output,
+    bool limited_range) {
+    constexpr size_t block = symcpp::ComplexBatchEvaluator::block_size;
+    symcpp::ComplexBatchEvaluator evaluator(compiled, limited_range);
+
+    symcpp::profile::ScopedTimer timer("eval");
+
+    std::map<std::string, symcpp::MappedArray<symcpp::Complex128_t>> columns;
+    for (const auto& input : inputs) {
+        size_t eq_pos = input.find('=');
+        if (eq_pos == std::string::npos) {
+            throw std::runtime_error("Expected NAME=PATH, got: " + input);
+        }
+        std::string name = input.substr(0, eq_pos);
+        symcpp::MappedArray<symcpp::Complex128_t> column(
+            input.substr(eq_pos + 1));
+        if (!columns.empty() &&
+            column.size() != columns.begin()->second.size()) {
+            throw std::runtime_error("Input columns differ in length: " +
+                                     input);
+        }
+        variables[name] = symcpp::Complexes_t{};
+        columns.insert_or_assign(name, std::move(column));
+    }
+
+    const auto& names = evaluator.variables();
+    std::vector<symcpp::Complexes_t> scalars = compiled.bind(variables);
+    std::vector<std::vector<double>> re(names.size(),
+                                        std::vector<double>(block));
+    std::vector<std::vector<double>> im(names.size(),
+                                        std::vector<double>(block));
+    std::vector<const symcpp::MappedArray<symcpp::Complex128_t>*> sources(
+        names.size());
+    std::vector<const double*> re_bound, im_bound;
+    for (size_t v = 0; v < names.size(); ++v) {
+        auto it = columns.find(names[v]);
+        if (it != columns.end()) {
+            sources[v] = &it->second;
+        } else {
+            std::fill(re[v].begin(), re[v].end(),
+                      static_cast<double>(scalars[v].real()));
+            std::fill(im[v].begin(), im[v].end(),
+                      static_cast<double>(scalars[v].imag()));
+        }
+        re_bound.push_back(re[v].data());
+        im_bound.push_back(im[v].data());
+    }
+
+    size_t outputs = evaluator.outputs();
+    size_t rows = columns.empty() ? 1 : columns.begin()->second.size();
+    symcpp::MappedArray<symcpp::Complex128_t> results;
+    if (!output.empty()) {
+        results =
+            symcpp::MappedArray<symcpp::Complex128_t>(output, rows * outputs);
+    }
+
+    symcpp::ComplexBatchEvaluator::Workspace workspace;
+    std::vector<std::vector<double>> re_values(outputs,
+                                               std::vector<double>(block));
+    std::vector<std::vector<double>> im_values(outputs,
+                                               std::vector<double>(block));
+    std::vector<double*> re_targets, im_targets;
+    for (size_t k = 0; k < outputs; ++k) {
+        re_targets.push_back(re_values[k].data());
+        im_targets.push_back(im_values[k].data());
+    }
+
+    for (size_t offset = 0; offset < rows; offset += block) {
+        size_t n = std::min(block, rows - offset);
+        for (size_t v = 0; v < names.size(); ++v) {
+            if (!sources[v]) {
+                continue;
+            }
+            const symcpp::Complex128_t* data = sources[v]->data() + offset;
+            for (size_t r = 0; r < n; ++r) {
+                re[v][r] = data[r].real();
+                im[v][r] = data[r].imag();
+            }
+        }
+        evaluator.eval_batch(re_bound.data(), im_bound.data(), n,
+                             re_targets.data(), im_targets.data(), workspace);
+
+        for (size_t r = 0; r < n; ++r) {
+            for (size_t k = 0; k < outputs; ++k) {
+                symcpp::Complex128_t value(re_values[k][r], im_values[k][r]);
+                if (output.empty()) {
+                    std::cout << value << (k + 1 < outputs ? ' ' : '\n');
+                } else {
+                    results[(offset + r) * outputs + k] = value;
+                }
+            }
+        }
+    }
+}
+
+template <typename _Domain>
+void run(const symcpp::CompiledExpression<_Domain>& compiled,
+         std::map<std::string, _Domain> variables,
+         const std::vector<std::string>& inputs, const std::string& output,
+         bool labelled, const BatchOptions& batch) {
+    if constexpr (!std::is_same_v<_Domain, double>) {
+        if (batch.mixed_tolerance > 0) {
+            throw std::runtime_error(
+                "--mixed-precision requires a real double expression");
+        }
+    }
+    if constexpr (std::is_same_v<_Domain, symcpp::Complexes_t>) {
+        if (batch.split_complex && (!inputs.empty() || !output.empty())) {
+            evaluate_split(compiled, std::move(variables), inputs, output,
+                           batch.limited_range);
+            return;
+        }
+    }
+    if (!inputs.empty() || !output.empty()) {
+        evaluate_binary(compiled, std::move(variables), inputs, output, batch);
+        return;
+    }
+
+    symcpp::profile::ScopedTimer timer("eval");
+    typename symcpp::CompiledExpression<_Domain>::Workspace workspace;
+    std::vector<_Domain> values(compiled.outputs().size());
+    compiled.eval(compiled.bind(variables).data(), values.data(), workspace);
+    for (size_t k = 0; k < values.size(); ++k) {
+        if (labelled) {
+            std::cout << compiled.labels()[k] << ": ";
+        }
+        std::cout << values[k] << std::endl;
+    }
+}
+
+template <typename _Domain>
+void evaluate(const symcpp::Expression<_Domain>& expr,
+              const std::map<std::string, symcpp::Complexes_t>& values,
+              const std::vector<std::string>& inputs, const std::string& output,
+              const BatchOptions& batch) {
+    auto compiled = symcpp::profile::timed(
+        "compile", [&] { return symcpp::CompiledExpression<_Domain>(expr); });
+    run(compiled, domain_variables<_Domain>(values), inputs, output, false,
+        batch);
+}
+
+template <typename _Domain>
+std::vector<std::string> gradient_variables(
+    const symcpp::Expression<_Domain>& expr) {
+    std::vector<std::string> by;
+    for (const auto& variable : expr.variables()) {
+        if (!std::is_same_v<_Domain, symcpp::Complexes_t> || variable != "i") {
+            by.push_back(variable);
+        }
+    }
+    return by;
+}
+
+template <typename _Domain>
+void differentiate(const symcpp::Expression<_Domain>& expr,
+                   const std::string& diff_var) {
+    auto diff_expr =
+        symcpp::profile::timed("diff", [&] { return expr.diff(diff_var); });
+    auto text = symcpp::profile::timed(
+        "to_string", [&] { return diff_expr.to_string(); });
+    std::cout << text << std::endl;
+}
+
+template <typename _Domain>
+void gradient(const symcpp::Expression<_Domain>& expr,
+              std::vector<std::string> by,
+              const std::map<std::string, symcpp::Complexes_t>& values,
+              const std::vector<std::string>& inputs, const std::string& output,
+              const BatchOptions& batch) {
+    if (by.empty()) {
+        by = gradient_variables(expr);
+    }
+    auto partials =
+        symcpp::profile::timed("diff", [&] { return expr.gradient(by); });
+
+    if (values.empty() && inputs.empty() && output.empty()) {
+        for (size_t k = 0; k < by.size(); ++k) {
+            std::cout << by[k] << ": " << partials[k] << std::endl;
+        }
+        return;
+    }
+
+    auto compiled = symcpp::profile::timed("compile", [&] {
+        return symcpp::CompiledExpression<_Domain>(partials, by);
+    });
+    run(compiled, domain_variables<_Domain>(values), inputs, output, true,
+        batch);
+}
+
+template <typename _Domain>
+void compile(const symcpp::Expression<_Domain>& expr, bool with_gradient,
+             std::vector<std::string> by, const std::string& path) {
+    std::vector<symcpp::Expression<_Domain>> outputs = {expr};
+    std::vector<std::string> labels = {"f"};
+    if (with_gradient) {
+        if (by.empty()) {
+            by = gradient_variables(expr);
+        }
+        auto partials =
+            symcpp::profile::timed("diff", [&] { return expr.gradient(by); });
+        for (size_t k = 0; k < by.size(); ++k) {
+            outputs.push_back(partials[k]);
+            labels.push_back("df/d" + by[k]);
+        }
+    }
+
+    auto compiled = symcpp::profile::timed("compile", [&] {
+        return symcpp::CompiledExpression<_Domain>(outputs, labels);
+    });
+    symcpp::profile::ScopedTimer timer("save");
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot create " + path);
+    }
+    compiled.save(file);
+}
+
+template <typename _Domain>
+void run_file(std::istream& file,
+              const std::map<std::string, symcpp::Complexes_t>& values,
+              const std::vector<std::string>& inputs, const std::string& output,
+              const BatchOptions& batch) {
+    auto compiled = symcpp::profile::timed("load", [&] {
+        return symcpp::CompiledExpression<_Domain>::load(file);
+    });
+    run(compiled, domain_variables<_Domain>(values), inputs, output,
+        compiled.outputs().size() > 1, batch);
+}
+
+template <typename Real, typename F>
+void dispatch_real(const std::string& expression_str,
+                   std::map<std::string, symcpp::Complexes_t> bound,
+                   const std::vector<std::string>& inputs, bool force_complex,
+                   F&& f) {
+    auto expr = symcpp::profile::timed("parse", [&] {
+        return symcpp::parse_expression<Real>(expression_str);
+    });
+    for (const auto& input : inputs) {
+        bound[input.substr(0, input.find('='))] = 0;
+    }
+
+    bool use_complex = force_complex || symcpp::profile::timed("infer", [&] {
+                           return symcpp::requires_complex(expr, bound);
+                       });
+    if (use_complex) {
+        f(symcpp::profile::timed("parse", [&] {
+            return symcpp::parse_expression<symcpp::Complexes_t>(
+                expression_str);
+        }));
+    } else {
+        f(expr);
+    }
+}
+
+template <typename F>
+void dispatch(const std::string& expression_str,
+              const std::map<std::string, symcpp::Complexes_t>& bound,
+              const std::vector<std::string>& inputs, bool force_complex,
+              const std::string& precision, F&& f) {
+    if (precision == "float") {
+        dispatch_real<float>(expression_str, bound, inputs, force_complex, f);
+    } else if (precision == "double") {
+        dispatch_real<double>(expression_str, bound, inputs, force_complex,
+                              f);
+    } else if (precision == "long") {
+        dispatch_real<long double>(expression_str, bound, inputs,
+                                   force_complex, f);
+    } else if (precision == "double-double") {
+        dispatch_real<symcpp::DoubleDouble>(expression_str, bound, inputs,
+                                            force_complex, f);
+    } else {
+        throw std::runtime_error("Unknown precision: " + precision);
+    }
+}
+
 int main(int argc, char* argv[]) {
     cxxopts::Options options(
         "differentiator", "A symbolic differentiator and expression evaluator");
@@ -39,8 +505,47 @@ int main(int argc, char* argv[]) {
     options.add_options()("e,eval", "Evaluate expression with given variables",
                           cxxopts::value<std::string>())(
         "d,diff", "Differentiate expression with respect to a variable",
-        cxxopts::value<std::string>())("b,by", "Variable to differentiate by",
-                                       cxxopts::value<std::string>())(
+        cxxopts::value<std::string>())(
+        "g,gradient",
+        "Differentiate expression with respect to every variable in --by "
+        "(all of its variables by default)",
+        cxxopts::value<std::string>())(
+        "b,by", "Variable to differentiate by (comma-separated for --gradient)",
+        cxxopts::value<std::string>())(
+        "input-binary",
+        "Read variable column NAME=PATH as raw little-endian float64 "
+        "(complex128 for complex expressions and --complex)",
+        cxxopts::value<std::vector<std::string>>())(
+        "output-binary", "Write evaluation results to PATH as raw binary",
+        cxxopts::value<std::string>())(
+        "profile",
+        "Print per-phase timings and counters to stderr "
+        "(--profile=json for JSON)",
+        cxxopts::value<std::string>()->implicit_value("text"))(
+        "compile", "Compile expression into the artifact given by --output",
+        cxxopts::value<std::string>())(
+        "o,output", "Path of the compiled artifact",
+        cxxopts::value<std::string>())(
+        "with-gradient",
+        "Also compile the partial derivatives by --by (all variables by "
+        "default)")(
+        "run", "Evaluate a compiled artifact with given variables",
+        cxxopts::value<std::string>())(
+        "complex",
+        "Use complex arithmetic even when the expression and its inputs "
+        "are real")(
+        "precision",
+        "Real arithmetic precision: float, double, long or double-double",
+        cxxopts::value<std::string>()->default_value("double"))(
+        "limited-range",
+        "Skip overflow and NaN recovery in complex multiplication, division "
+        "and logarithm over binary columns")(
+        "mixed-precision",
+        "Evaluate binary columns in float and re-evaluate in double the "
+        "rows whose estimated relative error exceeds TOL (useful for TOL "
+        "from about 1e-5 to 1e-2 on expressions of up to a few hundred "
+        "nodes; deeper expressions end up refined almost entirely)",
+        cxxopts::value<double>())(
         "h,help", "Print usage");
 
     auto result = options.parse(argc, argv);
@@ -50,69 +555,109 @@ int main(int argc, char* argv[]) {
         return 0;
     }
 
-    if (result.count("eval")) {
-        std::string expression_str = result["eval"].as<std::string>();
-        bool use_complex = contains_imaginary_unit(expression_str);
-
-        for (int i = 1; i < argc && !use_complex; ++i) {
-            if (contains_imaginary_unit(argv[i])) {
-                use_complex = true;
-            }
+    std::string profile_format;
+    if (result.count("profile")) {
+        profile_format = result["profile"].as<std::string>();
+        if (profile_format != "text" && profile_format != "json") {
+            std::cerr << "Unknown profile format: " << profile_format
+                      << std::endl;
+            return 1;
         }
+        symcpp::profile::enable();
+    }
 
-        if (use_complex) {
-            std::map<std::string, symcpp::Complexes_t> variables;
-            for (int i = 1; i < argc; ++i) {
-                std::string arg = argv[i];
-                size_t eq_pos = arg.find('=');
-                if (eq_pos != std::string::npos) {
-                    std::string var_name = arg.substr(0, eq_pos);
-                    std::string var_value_str = arg.substr(eq_pos + 1);
-                    symcpp::Complexes_t var_value =
-                        parse_complex(var_value_str);
-                    variables[var_name] = var_value;
-                }
-            }
+    auto values = parse_variables(result.unmatched());
+    bool force_complex = result.count("complex") > 0;
+    std::string precision = result["precision"].as<std::string>();
+    BatchOptions batch;
+    batch.split_complex = precision != "long";
+    batch.limited_range = result.count("limited-range") > 0;
+    if (result.count("mixed-precision")) {
+        if (precision != "double" || force_complex) {
+            std::cerr << "--mixed-precision requires --precision double and "
+                         "no --complex"
+                      << std::endl;
+            return 1;
+        }
+        batch.mixed_tolerance = result["mixed-precision"].as<double>();
+    }
 
-            auto expr =
-                symcpp::parse_expression<symcpp::Complexes_t>(expression_str);
-            std::cout << expr.eval(variables) << std::endl;
-        } else {
-            std::map<std::string, symcpp::Reals_t> variables;
-            for (int i = 1; i < argc; ++i) {
-                std::string arg = argv[i];
-                size_t eq_pos = arg.find('=');
-                if (eq_pos != std::string::npos) {
-                    std::string var_name = arg.substr(0, eq_pos);
-                    symcpp::Reals_t var_value =
-                        std::stod(arg.substr(eq_pos + 1));
-                    variables[var_name] = var_value;
-                }
-            }
+    std::vector<std::string> inputs;
+    if (result.count("input-binary")) {
+        inputs = result["input-binary"].as<std::vector<std::string>>();
+    }
+    std::string output;
+    if (result.count("output-binary")) {
+        output = result["output-binary"].as<std::string>();
+    }
+    std::vector<std::string> by;
+    if (result.count("by")) {
+        by = split_list(result["by"].as<std::string>());
+    }
 
-            auto expr =
-                symcpp::parse_expression<symcpp::Reals_t>(expression_str);
-            std::cout << expr.eval(variables) << std::endl;
-        }
+    if (result.count("eval")) {
+        dispatch(result["eval"].as<std::string>(), values, inputs,
+                 force_complex, precision, [&](const auto& expr) {
+                     evaluate(expr, values, inputs, output, batch);
+                 });
     }
 
     if (result.count("diff")) {
-        std::string expression_str = result["diff"].as<std::string>();
         std::string diff_var = result["by"].as<std::string>();
-        bool use_complex = contains_imaginary_unit(expression_str);
+        dispatch(result["diff"].as<std::string>(), {}, {}, force_complex,
+                 precision,
+                 [&](const auto& expr) { differentiate(expr, diff_var); });
+    }
 
-        if (use_complex) {
-            auto expr =
-                symcpp::parse_expression<symcpp::Complexes_t>(expression_str);
-            auto diff_expr = expr.diff(diff_var);
-            std::cout << diff_expr << std::endl;
+    if (result.count("gradient")) {
+        dispatch(result["gradient"].as<std::string>(), values, inputs,
+                 force_complex, precision, [&](const auto& expr) {
+                     gradient(expr, by, values, inputs, output, batch);
+                 });
+    }
+
+    if (result.count("compile")) {
+        if (!result.count("output")) {
+            std::cerr << "--compile requires --output" << std::endl;
+            return 1;
+        }
+        std::string path = result["output"].as<std::string>();
+        bool with_gradient = result.count("with-gradient") > 0;
+        dispatch(result["compile"].as<std::string>(), {}, {}, force_complex,
+                 precision, [&](const auto& expr) {
+                     compile(expr, with_gradient, by, path);
+                 });
+    }
+
+    if (result.count("run")) {
+        std::string path = result["run"].as<std::string>();
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "Cannot open " << path << std::endl;
+            return 1;
+        }
+
+        std::string domain = symcpp::compiled_domain(file);
+        if (domain == symcpp::DomainName<symcpp::Complexes_t>::value) {
+            run_file<symcpp::Complexes_t>(file, values, inputs, output,
+                                          batch);
+        } else if (domain == symcpp::DomainName<float>::value) {
+            run_file<float>(file, values, inputs, output, batch);
+        } else if (domain == symcpp::DomainName<double>::value) {
+            run_file<double>(file, values, inputs, output, batch);
+        } else if (domain == symcpp::DomainName<symcpp::DoubleDouble>::value) {
+            run_file<symcpp::DoubleDouble>(file, values, inputs, output,
+                                           batch);
         } else {
-            auto expr =
-                symcpp::parse_expression<symcpp::Reals_t>(expression_str);
-            auto diff_expr = expr.diff(diff_var);
-            std::cout << diff_expr << std::endl;
+            run_file<long double>(file, values, inputs, output, batch);
         }
     }
 
+    if (profile_format == "json") {
+        symcpp::profile::report_json(std::cerr);
+    } else if (profile_format == "text") {
+        symcpp::profile::report(std::cerr);
+    }
+
     return 0;
 }
@@ -0,0 +1,99 @@
+// Replaces the global operator new and delete so that allocation.hpp can
+// count allocations. Link the allocation_hooks target into a program to
+// opt in; everything else only needs allocation.hpp.
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "allocation.hpp"
+
+namespace symcpp {
+namespace allocation {
+namespace detail {
+namespace {
+constexpr size_t header = alignof(std::max_align_t);
+
+struct Header {
+    size_t size;
+    uint8_t kind;
+};
+
+static_assert(sizeof(Header) <= header);
+
+void* allocate(size_t size) noexcept {
+    void* block = std::malloc(size + header);
+    if (!block) {
+        return nullptr;
+    }
+    auto* prefix = static_cast<Header*>(block);
+    prefix->size = size;
+    prefix->kind = current_kind;
+    record_allocation(size);
+    return static_cast<char*>(block) + header;
+}
+
+void release(void* pointer) noexcept {
+    if (!pointer) {
+        return;
+    }
+    void* block = static_cast<char*>(pointer) - header;
+    const auto* prefix = static_cast<const Header*>(block);
+    record_free(prefix->size, prefix->kind);
+    std::free(block);
+}
+
+const bool hooks_installed = [] {
+    installed_flag.store(true, std::memory_order_relaxed);
+    return true;
+}();
+};  // namespace
+};  // namespace detail
+};  // namespace allocation
+};  // namespace symcpp
+
+void* operator new(std::size_t size) {
+    if (void* pointer = symcpp::allocation::detail::allocate(size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* pointer = symcpp::allocation::detail::allocate(size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return symcpp::allocation::detail::allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return symcpp::allocation::detail::allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    symcpp::allocation::detail::release(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    symcpp::allocation::detail::release(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    symcpp::allocation::detail::release(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    symcpp::allocation::detail::release(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    symcpp::allocation::detail::release(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    symcpp::allocation::detail::release(pointer);
+}
@@ -1,6 +1,34 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <sstream>
+
+#include "allocation.hpp"
+#include "banded.hpp"
+#include "binary_io.hpp"
+#include "chebyshev.hpp"
+#include "compiled.hpp"
+#include "complex_batch.hpp"
+#include "domain.hpp"
+#include "double_double.hpp"
 #include "expression.hpp"
+#include "fitting.hpp"
+#include "generator.hpp"
+#include "global.hpp"
+#include "interval.hpp"
+#include "minimize.hpp"
+#include "mixed_precision.hpp"
+#include "montecarlo.hpp"
+#include "node_profile.hpp"
+#include "ode.hpp"
+#include "profile.hpp"
+#include "quadrature.hpp"
+#include "roots.hpp"
+#include "sampling.hpp"
+#include "series.hpp"
+#include "systems.hpp"
 
 TEST(ExpressionParsingTest, SimpleAddition) {
     auto expr = symcpp::parse_expression("2 + 2 * 2");
@@ -31,6 +59,19 @@ TEST(ExpressionParsingTest, SinFunction) {
     EXPECT_EQ(expr.eval(vars), 0);
 }
 
+TEST(ExpressionParsingTest, DoubleAndFloatDomains) {
+    auto expr = symcpp::parse_expression<double>("0.1 * x + 2");
+    EXPECT_EQ(expr.eval({{"x", 3}}), 0.1 * 3 + 2);
+    EXPECT_EQ(expr.diff("x").eval({}), 0.1);
+
+    auto single = symcpp::parse_expression<float>("0.1 * x ^ 2");
+    EXPECT_EQ(single.eval({{"x", 2}}), 0.1f * 4);
+    EXPECT_EQ(single.diff("x").eval({{"x", 1}}), 2 * 0.1f);
+
+    EXPECT_THROW(symcpp::parse_expression<double>("1.2.3"),
+                 std::runtime_error);
+}
+
 TEST(SymbolicDifferentiationTest, PowerFunction) {
     auto expr = symcpp::parse_expression("x ^ 2");
     auto diff_expr = expr.diff("x");
@@ -38,6 +79,21 @@ TEST(SymbolicDifferentiationTest, PowerFunction) {
     EXPECT_EQ(diff_expr.eval(vars), 4);
 }
 
+TEST(SymbolicDifferentiationTest, ConstantExponentUsesPowerRule) {
+    auto cube = symcpp::parse_expression("x ^ 3").diff("x");
+    std::string text = cube.to_string();
+    EXPECT_EQ(text.find("ln"), std::string::npos) << text;
+    EXPECT_EQ(text.find('/'), std::string::npos) << text;
+    EXPECT_EQ(cube.eval({{"x", 0}}), 0);
+    EXPECT_EQ(cube.eval({{"x", 2}}), 12);
+
+    auto square = symcpp::parse_expression("sin(x) ^ 2").diff("x");
+    EXPECT_EQ(square.eval({{"x", 0}}), 0);
+
+    auto general = symcpp::parse_expression("x ^ x").diff("x");
+    EXPECT_NE(general.to_string().find("ln"), std::string::npos);
+}
+
 TEST(SymbolicDifferentiationTest, SinFunction) {
     auto expr = symcpp::parse_expression("sin(x)");
     auto diff_expr = expr.diff("x");
@@ -64,6 +120,1543 @@ TEST(SymbolicDifferentiationTest, Ex2Function) {
     EXPECT_EQ(diff_expr.to_string(), "(sin(x) + (x * cos(x)))");
 }
 
+TEST(SymbolicDifferentiationTest, ExpFunction) {
+    auto expr = symcpp::parse_expression("exp(2 * x)");
+    auto diff_expr = expr.diff("x");
+    std::map<std::string, symcpp::Reals_t> vars = {{"x", 0}};
+    EXPECT_EQ(diff_expr.eval(vars), 2);
+}
+
+TEST(SymbolicDifferentiationTest, Gradient) {
+    auto expr = symcpp::parse_expression("x * y + sin(z)");
+    EXPECT_EQ(expr.variables(), (std::set<std::string>{"x", "y", "z"}));
+
+    auto partials = expr.gradient({"x", "y", "z", "w"});
+    ASSERT_EQ(partials.size(), 4u);
+    std::map<std::string, symcpp::Reals_t> vars = {
+        {"x", 2}, {"y", 3}, {"z", 0}};
+    EXPECT_EQ(partials[0].eval(vars), 3);
+    EXPECT_EQ(partials[1].eval(vars), 2);
+    EXPECT_EQ(partials[2].eval(vars), 1);
+    EXPECT_EQ(partials[3].to_string(), "0");
+}
+
+TEST(SymbolicDifferentiationTest, GradientMatchesDiffOnSharedExpressions) {
+    symcpp::GeneratorOptions options;
+    options.size = 60;
+    options.variables = 4;
+    options.sharing = 0.3;
+    options.weights[size_t(symcpp::NodeKind::Ln)] = 0;
+    symcpp::ExpressionGenerator<double> generator(options, 3);
+    const auto& names = generator.variables();
+    std::map<std::string, double> point;
+    for (size_t v = 0; v < names.size(); ++v) {
+        point[names[v]] = 0.3 + 0.15 * v;
+    }
+    for (int round = 0; round < 10; ++round) {
+        auto expr = generator.expression();
+        auto partials = expr.gradient(names);
+        ASSERT_EQ(partials.size(), names.size());
+        for (size_t v = 0; v < names.size(); ++v) {
+            double expected = expr.diff(names[v]).eval(point);
+            if (!std::isfinite(expected)) {
+                continue;
+            }
+            EXPECT_NEAR(partials[v].eval(point), expected,
+                        1e-9 * (1 + std::fabs(expected)))
+                << round << " " << names[v];
+        }
+    }
+}
+
+TEST(SymbolicDifferentiationTest, GradientIsLinearInSharedDepth) {
+    symcpp::Expression<double> x("x"), y("y");
+    symcpp::Expression<double> f = x;
+    double value = 0.3, dx = 1, dy = 0;
+    for (int level = 0; level < 40; ++level) {
+        f = f * f.sin() + y;
+        double slope = std::sin(value) + value * std::cos(value);
+        dx *= slope;
+        dy = dy * slope + 1;
+        value = value * std::sin(value) + 0.1;
+    }
+    auto partials = f.gradient({"x", "y"});
+    std::map<std::string, double> point = {{"x", 0.3}, {"y", 0.1}};
+    symcpp::CompiledExpression<double> compiled(f);
+    symcpp::CompiledExpression<double> by_x(partials[0]), by_y(partials[1]);
+    EXPECT_NEAR(compiled.eval(point), value, 1e-14);
+    EXPECT_NEAR(by_x.eval(point), dx, 1e-12 * (1 + std::fabs(dx)));
+    EXPECT_NEAR(by_y.eval(point), dy, 1e-12 * (1 + std::fabs(dy)));
+}
+
+TEST(SymbolicDifferentiationTest, GradientSkipsInactiveLogarithms) {
+    auto expr = symcpp::parse_expression<double>("x ^ y + x / y");
+    auto partials = expr.gradient({"x"});
+    std::map<std::string, double> point = {{"x", -2.0}, {"y", 3.0}};
+    EXPECT_NEAR(partials[0].eval(point), 3 * 4 + 1.0 / 3, 1e-12);
+    auto both = expr.gradient({"y", "x"});
+    EXPECT_NEAR(both[1].eval(point), partials[0].eval(point), 1e-12);
+    EXPECT_THROW(both[0].eval(point), std::runtime_error);
+}
+
+TEST(ExpressionPrintingTest, ConstantsRoundTripThroughParser) {
+    EXPECT_EQ(symcpp::Expression<double>(0.1).to_string(), "0.1");
+    EXPECT_EQ(symcpp::Expression<float>(0.1f).to_string(), "0.1");
+    EXPECT_EQ(symcpp::Expression<double>(2.0).to_string(), "2");
+    EXPECT_EQ(symcpp::to_string(symcpp::Complexes_t(0.5, -2)), "(0.5, -2)");
+
+    for (double value : {1.0 / 3, 1e-20, 123456.789, 6.02214076e23}) {
+        std::string text = symcpp::Expression<double>(value).to_string();
+        EXPECT_EQ(symcpp::parse_expression<double>(text).eval({}), value)
+            << text;
+    }
+    long double third = 1.0L / 3;
+    std::string text = symcpp::Expression<long double>(third).to_string();
+    EXPECT_EQ(symcpp::parse_expression<long double>(text).eval({}), third);
+    EXPECT_EQ(symcpp::Expression<double>(-0.25).to_string(), "-0.25");
+}
+
+TEST(ProfileTest, CountersAndTimers) {
+    symcpp::profile::reset();
+    symcpp::parse_expression("x + 1");
+    EXPECT_EQ(symcpp::profile::value(symcpp::profile::Counter::NodesCreated),
+              0u);
+
+    symcpp::profile::enable();
+    auto expr = symcpp::profile::timed(
+        "parse", [] { return symcpp::parse_expression("x * (2 + 3)"); });
+    EXPECT_THROW(expr.eval({}), std::runtime_error);
+    symcpp::profile::enable(false);
+
+    using symcpp::profile::Counter;
+    EXPECT_GT(symcpp::profile::value(Counter::NodesCreated), 0u);
+    EXPECT_EQ(symcpp::profile::value(Counter::ConstantFolds), 1u);
+    EXPECT_EQ(symcpp::profile::value(Counter::Evaluations), 2u);
+    EXPECT_EQ(symcpp::profile::value(Counter::Exceptions), 1u);
+
+    std::ostringstream json;
+    symcpp::profile::report_json(json);
+    EXPECT_NE(json.str().find("{\"name\": \"parse\""), std::string::npos);
+    EXPECT_NE(json.str().find("\"exceptions\": 1"), std::string::npos);
+    symcpp::profile::reset();
+}
+
+TEST(CompiledExpressionTest, MatchesTreeEvaluation) {
+    auto expr = symcpp::parse_expression("x * sin(y) + x * sin(y) / exp(x)");
+    symcpp::CompiledExpression<> compiled(expr);
+    EXPECT_EQ(compiled.variables(), (std::vector<std::string>{"x", "y"}));
+    EXPECT_EQ(compiled.instructions().size(), 7u);
+
+    std::map<std::string, symcpp::Reals_t> vars = {{"x", 1.5}, {"y", 0.25}};
+    EXPECT_EQ(compiled.eval(vars), expr.eval(vars));
+    EXPECT_THROW(compiled.eval({{"x", 1}}), std::runtime_error);
+}
+
+TEST(CompiledExpressionTest, BatchEvaluation) {
+    auto expr = symcpp::parse_expression("x / y");
+    symcpp::CompiledExpression<> compiled({expr, expr.diff("y")});
+
+    size_t rows = 1000;
+    std::vector<symcpp::Reals_t> x(rows), y(rows), f(rows), dy(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        x[r] = r;
+        y[r] = r + 1;
+    }
+    const symcpp::Reals_t* columns[] = {x.data(), y.data()};
+    symcpp::Reals_t* results[] = {f.data(), dy.data()};
+    symcpp::CompiledExpression<>::Workspace workspace;
+    compiled.eval_batch(columns, rows, results, workspace);
+    for (size_t r = 0; r < rows; ++r) {
+        EXPECT_EQ(f[r], x[r] / y[r]);
+        EXPECT_EQ(dy[r], -x[r] / (y[r] * y[r]));
+    }
+
+    y[rows - 1] = 0;
+    EXPECT_THROW(compiled.eval_batch(columns, rows, results, workspace),
+                 std::runtime_error);
+}
+
+TEST(CompiledExpressionTest, BatchOrNanIsolatesFailingRows) {
+    auto expr = symcpp::parse_expression("ln(x) + y");
+    symcpp::CompiledExpression<> compiled({expr, expr.diff("x")});
+
+    std::vector<symcpp::Reals_t> x = {1, -1, 2, 0}, y = {0, 1, 2, 3};
+    std::vector<symcpp::Reals_t> f(4), dx(4);
+    const symcpp::Reals_t* columns[] = {x.data(), y.data()};
+    symcpp::Reals_t* results[] = {f.data(), dx.data()};
+    symcpp::CompiledExpression<>::Workspace workspace;
+    compiled.eval_batch_or_nan(columns, 4, results, workspace);
+    EXPECT_EQ(f[0], 0);
+    EXPECT_EQ(dx[0], 1);
+    EXPECT_TRUE(std::isnan(f[1]) && std::isnan(dx[1]));
+    EXPECT_EQ(f[2], std::log(symcpp::Reals_t(2)) + 2);
+    EXPECT_EQ(dx[2], 0.5);
+    EXPECT_TRUE(std::isnan(f[3]) && std::isnan(dx[3]));
+}
+
+TEST(CompiledExpressionTest, SlotsAppendUnboundParameters) {
+    symcpp::CompiledExpression<> compiled(
+        symcpp::parse_expression("a * x + b * y + a"));
+    std::vector<std::string> parameters = {"b"};
+    auto slots = compiled.slots({"y", "x"}, parameters);
+    EXPECT_EQ(parameters, (std::vector<std::string>{"b", "a"}));
+    EXPECT_EQ(compiled.variables(),
+              (std::vector<std::string>{"a", "x", "b", "y"}));
+    EXPECT_EQ(slots, (std::vector<uint32_t>{3, 1, 2, 0}));
+}
+
+TEST(CompiledExpressionTest, SaveAndLoad) {
+    auto expr = symcpp::parse_expression<symcpp::Complexes_t>("x * i + 2");
+    symcpp::CompiledExpression<symcpp::Complexes_t> compiled(
+        {expr, expr.diff("x")}, {"f", "df/dx"});
+
+    std::stringstream stream;
+    compiled.save(stream);
+    EXPECT_EQ(symcpp::compiled_domain(stream), "complex long double");
+    EXPECT_THROW(symcpp::CompiledExpression<>::load(stream),
+                 std::runtime_error);
+
+    stream.seekg(0);
+    auto loaded =
+        symcpp::CompiledExpression<symcpp::Complexes_t>::load(stream);
+    EXPECT_EQ(loaded.labels(), compiled.labels());
+    std::map<std::string, symcpp::Complexes_t> vars = {{"x", 3}};
+    EXPECT_EQ(loaded.eval(vars), symcpp::Complexes_t(2, 3));
+
+    std::string truncated = stream.str().substr(0, 40);
+    std::istringstream broken(truncated);
+    EXPECT_THROW(symcpp::CompiledExpression<symcpp::Complexes_t>::load(broken),
+                 std::runtime_error);
+}
+
+TEST(DomainInferenceTest, RequiresComplex) {
+    auto real = symcpp::parse_expression("sin(x) + pi * min");
+    EXPECT_FALSE(symcpp::requires_complex(real, {{"x", 1}}));
+    EXPECT_TRUE(symcpp::requires_complex(real, {{"x", {1, 2}}}));
+
+    auto unit = symcpp::parse_expression("x * i");
+    EXPECT_TRUE(symcpp::requires_complex(unit, {}));
+    EXPECT_FALSE(symcpp::requires_complex(unit, {{"i", 3}}));
+
+    EXPECT_TRUE(
+        symcpp::requires_complex(symcpp::parse_expression("ln(0 - 1)"), {}));
+}
+
+TEST(BinaryIOTest, MappedArrayRoundTrip) {
+    std::string path = ::testing::TempDir() + "symcpp_binary_io.f64";
+    {
+        symcpp::MappedArray<symcpp::Float64_t> out(path, 3);
+        out[0] = 1.5;
+        out[1] = -2;
+        out[2] = 4e10;
+    }
+    symcpp::MappedArray<symcpp::Float64_t> in(path);
+    ASSERT_EQ(in.size(), 3u);
+    EXPECT_EQ(in[0], 1.5);
+    EXPECT_EQ(in[1], -2);
+    EXPECT_EQ(in[2], 4e10);
+
+    EXPECT_THROW(symcpp::MappedArray<symcpp::Complex128_t>{path},
+                 std::runtime_error);
+}
+
+TEST(ComplexBatchTest, MatchesCompiledExpression) {
+    auto expr = symcpp::parse_expression<symcpp::Complexes_t>(
+        "sin(z) * w / (z + 2) + ln(w) ^ z - exp(i * z)");
+    symcpp::CompiledExpression<symcpp::Complexes_t> compiled(expr);
+
+    size_t rows = 600;
+    std::vector<double> z_re(rows), z_im(rows), w_re(rows), w_im(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        z_re[r] = 0.01 * r - 3;
+        z_im[r] = 0.5 - 0.002 * r;
+        w_re[r] = 1 + 0.003 * r;
+        w_im[r] = -0.7;
+    }
+    std::map<std::string, const double*> re = {{"w", w_re.data()},
+                                               {"z", z_re.data()}};
+    std::map<std::string, const double*> im = {{"w", w_im.data()},
+                                               {"z", z_im.data()}};
+    std::vector<double> zero(rows, 0.0), one(rows, 1.0);
+    re["i"] = zero.data();
+    im["i"] = one.data();
+
+    for (bool limited_range : {false, true}) {
+        symcpp::ComplexBatchEvaluator evaluator(compiled, limited_range);
+        std::vector<const double*> re_columns, im_columns;
+        for (const auto& name : evaluator.variables()) {
+            re_columns.push_back(re.at(name));
+            im_columns.push_back(im.at(name));
+        }
+        std::vector<double> f_re(rows), f_im(rows);
+        double* re_results[] = {f_re.data()};
+        double* im_results[] = {f_im.data()};
+        symcpp::ComplexBatchEvaluator::Workspace workspace;
+        evaluator.eval_batch(re_columns.data(), im_columns.data(), rows,
+                             re_results, im_results, workspace);
+
+        for (size_t r = 0; r < rows; ++r) {
+            std::map<std::string, symcpp::Complexes_t> vars = {
+                {"z", {z_re[r], z_im[r]}}, {"w", {w_re[r], w_im[r]}}};
+            symcpp::Complexes_t expected = compiled.eval(vars);
+            EXPECT_NEAR(f_re[r], static_cast<double>(expected.real()), 1e-9);
+            EXPECT_NEAR(f_im[r], static_cast<double>(expected.imag()), 1e-9);
+        }
+
+        z_re[rows - 1] = -2;
+        z_im[rows - 1] = 0;
+        EXPECT_THROW(evaluator.eval_batch(re_columns.data(),
+                                          im_columns.data(), rows, re_results,
+                                          im_results, workspace),
+                     std::runtime_error);
+        z_re[rows - 1] = 0.01 * (rows - 1) - 3;
+        z_im[rows - 1] = 0.5 - 0.002 * (rows - 1);
+    }
+}
+
+TEST(ComplexBatchTest, ZeroBasePowerMatchesCompiledExpression) {
+    auto expr = symcpp::parse_expression<symcpp::Complexes_t>("z ^ w");
+    symcpp::CompiledExpression<symcpp::Complexes_t> compiled(expr);
+    symcpp::ComplexBatchEvaluator evaluator(compiled);
+    std::vector<double> z_re(8, 0.0), z_im(8, 0.0);
+    std::vector<double> w_re = {0, -1, 2, 0.5, 1, 0, -1, -2};
+    std::vector<double> w_im = {0, 0, 0, 0, 1, 1, 1, 0};
+    std::map<std::string, const double*> re = {{"z", z_re.data()},
+                                               {"w", w_re.data()}};
+    std::map<std::string, const double*> im = {{"z", z_im.data()},
+                                               {"w", w_im.data()}};
+    std::vector<const double*> re_columns, im_columns;
+    for (const auto& name : evaluator.variables()) {
+        re_columns.push_back(re.at(name));
+        im_columns.push_back(im.at(name));
+    }
+    std::vector<double> f_re(8), f_im(8);
+    double* re_results[] = {f_re.data()};
+    double* im_results[] = {f_im.data()};
+    symcpp::ComplexBatchEvaluator::Workspace workspace;
+    evaluator.eval_batch(re_columns.data(), im_columns.data(), 8, re_results,
+                         im_results, workspace);
+    for (size_t r = 0; r < 8; ++r) {
+        symcpp::Complexes_t expected =
+            compiled.eval({{"z", {0, 0}}, {"w", {w_re[r], w_im[r]}}});
+        auto same = [](double actual, long double wanted) {
+            return std::isnan(wanted) ? std::isnan(actual)
+                                      : actual == double(wanted);
+        };
+        EXPECT_TRUE(same(f_re[r], expected.real())) << r;
+        EXPECT_TRUE(same(f_im[r], expected.imag())) << r;
+    }
+}
+
+TEST(IntervalTest, EnclosesPointEvaluations) {
+    using Bounds = symcpp::Interval<double>;
+    auto expr = symcpp::parse_expression<Bounds>(
+        "sin(x) * y ^ 2 - exp(x / 3) + ln(y) + cos(x * y)");
+    auto point = symcpp::parse_expression<double>(
+        "sin(x) * y ^ 2 - exp(x / 3) + ln(y) + cos(x * y)");
+    std::map<std::string, Bounds> box = {{"x", Bounds(-1, 2.5)},
+                                         {"y", Bounds(0.5, 1.5)}};
+    Bounds range = expr.eval(box);
+    for (int i = 0; i <= 20; ++i) {
+        for (int j = 0; j <= 20; ++j) {
+            std::map<std::string, double> vars = {{"x", -1 + 3.5 * i / 20},
+                                                  {"y", 0.5 + 1.0 * j / 20}};
+            EXPECT_TRUE(range.contains(point.eval(vars)));
+        }
+    }
+
+    symcpp::CompiledExpression<Bounds> compiled(expr);
+    Bounds compiled_range = compiled.eval(box);
+    EXPECT_LE(compiled_range.lower(), range.lower());
+    EXPECT_GE(compiled_range.upper(), range.upper());
+}
+
+TEST(IntervalTest, TrigonometricBoundsFollowPeriodicity) {
+    using Bounds = symcpp::Interval<double>;
+    Bounds sine = sin(Bounds(1, 2));
+    EXPECT_EQ(sine.upper(), 1);
+    EXPECT_NEAR(sine.lower(), std::sin(1.0), 1e-15);
+    Bounds cosine = cos(Bounds(3, 7));
+    EXPECT_EQ(cosine.lower(), -1);
+    EXPECT_EQ(cosine.upper(), 1);
+    EXPECT_LT(cos(Bounds(0.1, 0.2)).upper(), 1);
+    EXPECT_EQ(sin(Bounds(-100, 100)), Bounds(-1, 1));
+}
+
+TEST(IntervalTest, ArithmeticRoundsOutward) {
+    using Bounds = symcpp::Interval<double>;
+    EXPECT_TRUE(Bounds::outward(0.1, 0.1).contains(0.1));
+    EXPECT_EQ(Bounds(1) + Bounds(2), Bounds(3));
+    Bounds third = Bounds(1) / Bounds(3);
+    EXPECT_LT(third.lower(), third.upper());
+    EXPECT_EQ(std::nextafter(third.lower(), 1.0), third.upper());
+    EXPECT_LT(pow(Bounds(-2, 3), Bounds(2)).lower(), 1e-300);
+    EXPECT_GE(pow(Bounds(-2, 3), Bounds(2)).upper(), 9);
+}
+
+TEST(IntervalTest, PrintedBoundsEncloseTheInterval) {
+    using Bounds = symcpp::Interval<double>;
+    EXPECT_EQ(symcpp::to_string(Bounds(1e-9, 2e-9)),
+              "[0.000000001, 0.000000002]");
+    EXPECT_EQ(symcpp::to_string(Bounds(0.1, 0.1)), "[0.1, 0.1]");
+    EXPECT_EQ(symcpp::to_string(Bounds::entire()), "[-inf, inf]");
+
+    for (Bounds x : {Bounds(1) / Bounds(3), Bounds(-1e-300, 1e-300) * 3,
+                     Bounds::outward(0.1, 0.2)}) {
+        std::string text = symcpp::to_string(x);
+        size_t comma = text.find(", ");
+        EXPECT_EQ(std::stod(text.substr(1, comma - 1)), x.lower()) << text;
+        EXPECT_EQ(std::stod(text.substr(comma + 2)), x.upper()) << text;
+    }
+}
+
+TEST(IntervalTest, DivisionByIntervalContainingZero) {
+    using Bounds = symcpp::Interval<double>;
+    auto ratio = symcpp::parse_expression<Bounds>("1 / x");
+    Bounds half_line = ratio.eval({{"x", Bounds(0, 2)}});
+    EXPECT_LE(half_line.lower(), 0.5);
+    EXPECT_TRUE(std::isinf(half_line.upper()));
+    EXPECT_TRUE(std::isinf(ratio.eval({{"x", Bounds(-1, 2)}}).lower()));
+    EXPECT_THROW(ratio.eval({{"x", Bounds(0)}}), std::runtime_error);
+}
+
+TEST(IntervalTest, LogarithmClipsToDomain) {
+    using Bounds = symcpp::Interval<double>;
+    auto log = symcpp::parse_expression<Bounds>("ln(x)");
+    Bounds clipped = log.eval({{"x", Bounds(-1, 1)}});
+    EXPECT_TRUE(std::isinf(clipped.lower()));
+    EXPECT_GE(clipped.upper(), 0);
+    EXPECT_THROW(log.eval({{"x", Bounds(-2, 0)}}), std::runtime_error);
+}
+
+TEST(DoubleDoubleTest, ExtendedPrecisionArithmetic) {
+    using symcpp::DoubleDouble;
+    DoubleDouble third = DoubleDouble(1) / DoubleDouble(3);
+    DoubleDouble residual = third * 3 - 1;
+    EXPECT_LT(std::fabs(residual.high()), 1e-31);
+    EXPECT_EQ(pow(DoubleDouble(-2), DoubleDouble(3)), DoubleDouble(-8));
+    DoubleDouble root = pow(DoubleDouble(2), DoubleDouble(0.5));
+    EXPECT_LT(std::fabs((root * root - 2).high()), 1e-30);
+}
+
+TEST(DoubleDoubleTest, ParsesAndFormatsDecimals) {
+    using symcpp::DoubleDouble;
+    DoubleDouble tenth = DoubleDouble::parse("0.1");
+    EXPECT_LT(std::fabs((tenth * 10 - 1).high()), 1e-31);
+    EXPECT_EQ(DoubleDouble::parse("2.5e3"), DoubleDouble(2500));
+    EXPECT_EQ(DoubleDouble::parse("1.25").to_string(), "1.25");
+    EXPECT_THROW(DoubleDouble::parse("1.2.3"), std::runtime_error);
+    EXPECT_THROW(DoubleDouble::parse(""), std::runtime_error);
+    EXPECT_EQ(DoubleDouble(1e30).to_string(),
+              "1000000000000000019884624838656");
+    EXPECT_EQ(DoubleDouble::parse("-1e-30").to_string(),
+              "-0.000000000000000000000000000001");
+
+    for (DoubleDouble x : {DoubleDouble(7e37), DoubleDouble(1) / 3 / 1e24,
+                           -DoubleDouble(1e30) / 7, DoubleDouble(3e-30)}) {
+        auto printed = symcpp::parse_expression<DoubleDouble>(x.to_string());
+        EXPECT_TRUE(printed.variables().empty()) << x.to_string();
+        DoubleDouble back = printed.eval({});
+        EXPECT_LT(std::fabs(((back - x) / x).high()), 1e-30) << x.to_string();
+    }
+}
+
+TEST(DoubleDoubleTest, TranscendentalConstants) {
+    using symcpp::DoubleDouble;
+    DoubleDouble e = exp(DoubleDouble(1));
+    EXPECT_EQ(e.to_string(30), "2.71828182845904523536028747135");
+    EXPECT_LT(std::fabs((log(e) - 1).high()), 1e-31);
+    DoubleDouble pi = DoubleDouble::pi();
+    EXPECT_LT(std::fabs(sin(pi / 6).high() - 0.5), 1e-16);
+    EXPECT_LT(std::fabs((sin(pi / 6) - DoubleDouble(0.5)).high()), 1e-31);
+    EXPECT_LT(std::fabs((cos(pi * 5 / 3) - DoubleDouble(0.5)).high()), 1e-31);
+}
+
+TEST(DoubleDoubleTest, KeepsLowOrderBitsInExpressions) {
+    using symcpp::DoubleDouble;
+    auto expr = symcpp::parse_expression<DoubleDouble>("(x + y) - x");
+    std::map<std::string, DoubleDouble> vars = {{"x", DoubleDouble(1)},
+                                                {"y", DoubleDouble(1e-20)}};
+    EXPECT_EQ(expr.eval(vars), DoubleDouble(1e-20));
+    symcpp::CompiledExpression<DoubleDouble> compiled(expr);
+    EXPECT_EQ(compiled.eval(vars), DoubleDouble(1e-20));
+}
+
+TEST(DoubleDoubleTest, TranscendentalIdentities) {
+    using symcpp::DoubleDouble;
+    for (int k = -400; k <= 400; ++k) {
+        DoubleDouble x = DoubleDouble(k) / 37 + DoubleDouble(1e-20) * k;
+        DoubleDouble s = sin(x);
+        DoubleDouble c = cos(x);
+        EXPECT_LT(std::fabs((s * s + c * c - 1).high()), 4e-31) << k;
+        EXPECT_LT(std::fabs((sin(x * 2) - s * c * 2).high()), 4e-31) << k;
+        EXPECT_LT(std::fabs((exp(x) * exp(-x) - 1).high()), 4e-31) << k;
+        EXPECT_LT(std::fabs((exp(x) / exp(x / 2) - exp(x / 2)).high()),
+                  4e-31 * exp(x / 2).high())
+            << k;
+        if (k > 0) {
+            EXPECT_LT(std::fabs((log(exp(x)) - x).high()),
+                      4e-31 * std::max(1.0, x.high()))
+                << k;
+        }
+    }
+    EXPECT_NEAR(sin(DoubleDouble(1e6)).high(), std::sin(1e6), 1e-15);
+    EXPECT_NEAR(cos(DoubleDouble(-1e6)).high(), std::cos(-1e6), 1e-15);
+    EXPECT_EQ(exp(DoubleDouble(-800)), DoubleDouble(0));
+    EXPECT_TRUE(std::isinf(exp(DoubleDouble(800)).high()));
+    EXPECT_TRUE(std::isnan(sin(DoubleDouble(
+                                   std::numeric_limits<double>::infinity()))
+                               .high()));
+}
+
+TEST(MixedPrecisionTest, RefinesIllConditionedRows) {
+    auto expr = symcpp::parse_expression<double>("(x + y) - x + sin(y) / 2");
+    symcpp::CompiledExpression<double> compiled(expr);
+    symcpp::MixedPrecisionEvaluator evaluator(compiled, 1e-4);
+
+    size_t rows = 1000;
+    std::vector<double> x(rows), y(rows), f(rows), expected(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        x[r] = r % 100 == 0 ? 1e6 : 0.5;
+        y[r] = 0.001 * r + 0.1;
+    }
+    std::vector<const double*> columns;
+    for (const auto& name : evaluator.variables()) {
+        columns.push_back(name == "x" ? x.data() : y.data());
+    }
+    double* results[] = {f.data()};
+    double* reference[] = {expected.data()};
+    symcpp::MixedPrecisionEvaluator::Workspace workspace;
+    symcpp::MixedPrecisionEvaluator::Statistics statistics;
+    evaluator.eval_batch(columns.data(), rows, results, workspace,
+                         &statistics);
+    symcpp::CompiledExpression<double>::Workspace precise;
+    compiled.eval_batch(columns.data(), rows, reference, precise);
+
+    for (size_t r = 0; r < rows; ++r) {
+        EXPECT_NEAR(f[r], expected[r], 1e-4 * std::fabs(expected[r]));
+    }
+    EXPECT_EQ(statistics.rows, rows);
+    EXPECT_GE(statistics.refined, rows / 100);
+    EXPECT_LT(statistics.refined, rows / 2);
+}
+
+TEST(MixedPrecisionTest, RefinesDenominatorsThatUnderflowInFloat) {
+    auto ratio = symcpp::parse_expression<double>("x / y");
+    symcpp::MixedPrecisionEvaluator divide(
+        symcpp::CompiledExpression<double>(ratio), 1e-4);
+    std::vector<double> x = {0, 1, 3}, y = {1e-50, 1e-50, 2}, f(3);
+    const double* columns[] = {x.data(), y.data()};
+    double* results[] = {f.data()};
+    symcpp::MixedPrecisionEvaluator::Workspace workspace;
+    symcpp::MixedPrecisionEvaluator::Statistics statistics;
+    divide.eval_batch(columns, 3, results, workspace, &statistics);
+    EXPECT_EQ(f[0], 0);
+    EXPECT_EQ(f[1], 1e50);
+    EXPECT_EQ(f[2], 1.5);
+    EXPECT_EQ(statistics.refined, 2u);
+}
+
+TEST(MixedPrecisionTest, RefinesOnlyRowsOutsideFloatDomain) {
+    auto expr = symcpp::parse_expression<double>("ln(x - 1) + 1 / (x - 2)");
+    symcpp::CompiledExpression<double> compiled(expr);
+    symcpp::MixedPrecisionEvaluator evaluator(compiled, 1e-4);
+    size_t rows = 300;
+    std::vector<double> x(rows), f(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        x[r] = 3.0 + 0.01 * r;
+    }
+    x[7] = 1 + 1e-10;
+    x[200] = 2 + 1e-12;
+    const double* columns[] = {x.data()};
+    double* results[] = {f.data()};
+    symcpp::MixedPrecisionEvaluator::Workspace workspace;
+    symcpp::MixedPrecisionEvaluator::Statistics statistics;
+    evaluator.eval_batch(columns, rows, results, workspace, &statistics);
+    EXPECT_EQ(statistics.refined, 2u);
+    for (size_t r = 0; r < rows; ++r) {
+        double expected = std::log(x[r] - 1) + 1 / (x[r] - 2);
+        EXPECT_NEAR(f[r], expected, 1e-4 * std::fabs(expected)) << r;
+    }
+}
+
+TEST(MixedPrecisionTest, SmallRoundingOfTrigonometricResultsIsRelative) {
+    auto expr = symcpp::parse_expression<double>("sin(x) * 1000");
+    symcpp::MixedPrecisionEvaluator evaluator(
+        symcpp::CompiledExpression<double>(expr), 1e-5);
+    std::vector<double> x(64), f(64);
+    for (size_t r = 0; r < x.size(); ++r) {
+        x[r] = 1e-3 * (r + 1);
+    }
+    const double* columns[] = {x.data()};
+    double* results[] = {f.data()};
+    symcpp::MixedPrecisionEvaluator::Workspace workspace;
+    symcpp::MixedPrecisionEvaluator::Statistics statistics;
+    evaluator.eval_batch(columns, x.size(), results, workspace, &statistics);
+    EXPECT_EQ(statistics.refined, 0u);
+    for (size_t r = 0; r < x.size(); ++r) {
+        EXPECT_NEAR(f[r], 1000 * std::sin(x[r]), 1e-5 * f[r]);
+    }
+}
+
+TEST(RootFinderTest, BracketedSolveConverges) {
+    auto expr = symcpp::parse_expression<double>("x ^ 3 - a * x - 1");
+    symcpp::RootFinder<double> finder(expr, "x");
+    EXPECT_EQ(finder.parameters(), std::vector<std::string>{"a"});
+
+    auto root = finder.solve(1.0, 2.0, {{"a", 1.0}});
+    EXPECT_EQ(root.status, symcpp::RootStatus::Converged);
+    EXPECT_NEAR(root.x, 1.324717957244746, 1e-12);
+}
+
+TEST(RootFinderTest, ReportsInvalidBrackets) {
+    auto expr = symcpp::parse_expression<double>("x ^ 3 - a * x - 1");
+    symcpp::RootFinder<double> finder(expr, "x");
+    auto same_sign = finder.solve(3.0, 4.0, {{"a", 1.0}});
+    EXPECT_EQ(same_sign.status, symcpp::RootStatus::NotBracketed);
+    EXPECT_EQ(same_sign.x, 3.5);
+    EXPECT_EQ(same_sign.iterations, 0u);
+    EXPECT_EQ(finder.solve(2.0, 1.0, {{"a", 1.0}}).status,
+              symcpp::RootStatus::NotBracketed);
+
+    auto log = symcpp::parse_expression<double>("ln(x) - 1");
+    symcpp::RootFinder<double> newton(log, "x");
+    EXPECT_EQ(newton.solve(-1.0, 5.0).status,
+              symcpp::RootStatus::NotBracketed);
+    EXPECT_EQ(symcpp::root_status_name(symcpp::RootStatus::NotBracketed),
+              std::string("not_bracketed"));
+    EXPECT_NEAR(newton.solve(3.0, 3.0, 3.0, {}).x, std::exp(1.0), 1e-12);
+}
+
+TEST(RootFinderTest, NewtonFromGuess) {
+    auto log = symcpp::parse_expression<double>("ln(x) - 1");
+    symcpp::RootFinder<double> newton(log, "x");
+    EXPECT_NEAR(newton.solve(0.5).x, std::exp(1.0), 1e-12);
+    EXPECT_EQ(newton.solve(10.0).status, symcpp::RootStatus::Failed);
+}
+
+TEST(RootFinderTest, RootAtBracketEndpoint) {
+    auto expr = symcpp::parse_expression<double>("0 - x");
+    symcpp::RootFinder<double> finder(expr, "x");
+    auto left = finder.solve(0.0, 1.0);
+    EXPECT_EQ(left.status, symcpp::RootStatus::Converged);
+    EXPECT_EQ(left.x, 0.0);
+    auto right = finder.solve(-1.0, 0.0);
+    EXPECT_EQ(right.status, symcpp::RootStatus::Converged);
+    EXPECT_EQ(right.x, 0.0);
+
+    auto decreasing = symcpp::parse_expression<double>("1 - x");
+    symcpp::RootFinder<double> reversed(decreasing, "x");
+    EXPECT_NEAR(reversed.solve(0.0, 3.0).x, 1.0, 1e-12);
+}
+
+TEST(RootFinderTest, UnbracketedRunOutOfIterations) {
+    auto expr = symcpp::parse_expression<double>("x ^ 2 + 1");
+    symcpp::RootOptions options;
+    options.max_iterations = 20;
+    symcpp::RootFinder<double> finder(expr, "x", options);
+    auto root = finder.solve(0.5);
+    EXPECT_EQ(root.status, symcpp::RootStatus::MaxIterations);
+    EXPECT_EQ(root.iterations, 20u);
+}
+
+TEST(RootFinderTest, BatchSolvesEveryRow) {
+    auto expr = symcpp::parse_expression<double>("x ^ 3 - a * x - 1");
+    symcpp::RootFinder<double> finder(expr, "x");
+    size_t rows = 10000;
+    std::vector<double> a(rows), lower(rows, 0.0), upper(rows, 10.0),
+        guess(rows, 5.0), roots(rows);
+    std::vector<symcpp::RootStatus> status(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        a[r] = 0.001 * r;
+    }
+    const double* parameters[] = {a.data()};
+    finder.solve_batch(parameters, lower.data(), upper.data(), guess.data(),
+                       rows, roots.data(), status.data());
+    for (size_t r = 0; r < rows; ++r) {
+        ASSERT_EQ(status[r], symcpp::RootStatus::Converged);
+        double x = roots[r];
+        EXPECT_NEAR(x * x * x - a[r] * x - 1, 0, 1e-9 * (1 + a[r] * x));
+    }
+}
+
+TEST(BandedLuTest, ReordersShuffledChainAndMatchesDenseSolve) {
+    size_t n = 40;
+    std::vector<uint32_t> label(n);
+    std::iota(label.begin(), label.end(), uint32_t(0));
+    std::shuffle(label.begin(), label.end(), std::mt19937(5));
+    std::vector<double> dense(n * n, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        dense[label[i] * n + label[i]] = 0.5 + 0.01 * i;
+        if (i > 0) {
+            dense[label[i] * n + label[i - 1]] = 1.0 + 0.1 * (i % 3);
+        }
+        if (i + 1 < n) {
+            dense[label[i] * n + label[i + 1]] = -2.0;
+        }
+    }
+    std::vector<uint32_t> row_starts{0}, columns;
+    std::vector<double> values;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            if (dense[i * n + j] != 0) {
+                columns.push_back(j);
+                values.push_back(dense[i * n + j]);
+            }
+        }
+        row_starts.push_back(columns.size());
+    }
+    symcpp::BandedPattern pattern(n, row_starts, columns);
+    EXPECT_EQ(pattern.lower(), 1u);
+    EXPECT_EQ(pattern.upper(), 1u);
+
+    symcpp::BandedLuFactorization<double> banded;
+    symcpp::LuFactorization<double> reference;
+    ASSERT_TRUE(banded.factor(pattern, row_starts.data(), columns.data(),
+                              values.data()));
+    ASSERT_TRUE(reference.factor(dense.data(), n));
+    std::vector<double> x(n), y(n);
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = y[i] = std::sin(1.0 + i);
+    }
+    banded.solve(x.data());
+    reference.solve(y.data());
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_NEAR(x[i], y[i], 1e-10 * (1 + std::fabs(y[i])));
+        x[i] = y[i] = std::cos(2.0 * i);
+    }
+    banded.solve_transposed(x.data());
+    reference.solve_transposed(y.data());
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_NEAR(x[i], y[i], 1e-10 * (1 + std::fabs(y[i])));
+    }
+}
+
+TEST(BandedLuTest, NeverWidensNaturalBandAndDetectsSingularity) {
+    std::vector<uint32_t> row_starts{0, 2, 4, 5}, columns{0, 2, 0, 2, 1};
+    symcpp::BandedPattern pattern(3, row_starts, columns);
+    EXPECT_LE(pattern.lower() + pattern.upper(), 3u);
+
+    std::vector<double> values{1, 2, 2, 4, 3};
+    symcpp::BandedLuFactorization<double> lu;
+    EXPECT_FALSE(lu.factor(pattern, row_starts.data(), columns.data(),
+                           values.data()));
+    values = {1, 2, 2, 5, 3};
+    ASSERT_TRUE(lu.factor(pattern, row_starts.data(), columns.data(),
+                          values.data()));
+    double x[] = {5, 12, 6};
+    lu.solve(x);
+    EXPECT_NEAR(x[0], 1, 1e-14);
+    EXPECT_NEAR(x[1], 2, 1e-14);
+    EXPECT_NEAR(x[2], 2, 1e-14);
+}
+
+TEST(SystemSolverTest, NewtonWithBroydenUpdatesOnSparseChain) {
+    size_t n = 60;
+    std::vector<symcpp::Expression<double>> residuals;
+    std::vector<std::string> unknowns;
+    for (size_t i = 0; i < n; ++i) {
+        unknowns.push_back("x" + std::to_string(i));
+    }
+    for (size_t i = 0; i < n; ++i) {
+        symcpp::Expression<double> x(unknowns[i]);
+        symcpp::Expression<double> f = (3.0 - 2.0 * x) * x + 1.0;
+        if (i > 0) {
+            f = f - symcpp::Expression<double>(unknowns[i - 1]);
+        }
+        if (i + 1 < n) {
+            f = f - 2.0 * symcpp::Expression<double>(unknowns[i + 1]);
+        }
+        residuals.push_back(f);
+    }
+    symcpp::SystemSolver<double> solver(residuals, unknowns);
+    EXPECT_EQ(solver.sparsity().size(), 3 * n - 2);
+    auto solution = solver.solve(std::vector<double>(n, -1.0));
+    EXPECT_EQ(solution.status, symcpp::RootStatus::Converged);
+    EXPECT_LT(solution.jacobian_evaluations, solution.iterations);
+    std::map<std::string, double> point;
+    for (size_t j = 0; j < n; ++j) {
+        point[unknowns[j]] = solution.x[j];
+    }
+    for (const auto& f : residuals) {
+        EXPECT_NEAR(f.eval(point), 0, 1e-9);
+    }
+}
+
+TEST(SystemSolverTest, LeastSquaresOnOverdeterminedSystem) {
+    auto circle = symcpp::parse_expression<double>("x ^ 2 + y ^ 2 - r ^ 2");
+    auto line = symcpp::parse_expression<double>("x - y");
+    auto extra = symcpp::parse_expression<double>("x + y - 2");
+    symcpp::SystemSolver<double> fit({circle, line, extra}, {"x", "y"});
+    EXPECT_EQ(fit.parameters(), std::vector<std::string>{"r"});
+    auto exact = fit.solve({3.0, 0.5}, {{"r", std::sqrt(2.0)}});
+    EXPECT_EQ(exact.status, symcpp::RootStatus::Converged);
+    EXPECT_NEAR(exact.x[0], 1, 1e-9);
+    EXPECT_NEAR(exact.x[1], 1, 1e-9);
+}
+
+TEST(SystemSolverTest, RejectsMalformedProblems) {
+    auto sum = symcpp::parse_expression<double>("x + y - a");
+    EXPECT_THROW(symcpp::SystemSolver<double>({sum}, {"x", "y"}),
+                 std::runtime_error);
+    auto difference = symcpp::parse_expression<double>("x - y");
+    symcpp::SystemSolver<double> solver({sum, difference}, {"x", "y"});
+    EXPECT_THROW(solver.solve({1.0}, {{"a", 2.0}}), std::runtime_error);
+    EXPECT_THROW(solver.solve({1.0, 1.0}), std::runtime_error);
+    auto solution = solver.solve({0.0, 0.0}, {{"a", 2.0}});
+    EXPECT_EQ(solution.status, symcpp::RootStatus::Converged);
+    EXPECT_NEAR(solution.x[0], 1, 1e-12);
+}
+
+TEST(SystemSolverTest, SolvesChainWithShuffledUnknowns) {
+    size_t n = 120;
+    std::vector<std::string> unknowns;
+    for (size_t i = 0; i < n; ++i) {
+        unknowns.push_back("u" + std::to_string(i));
+    }
+    std::vector<std::string> chain = unknowns;
+    std::shuffle(chain.begin(), chain.end(), std::mt19937(11));
+    std::vector<symcpp::Expression<double>> residuals;
+    for (size_t i = 0; i < n; ++i) {
+        symcpp::Expression<double> u(chain[i]);
+        symcpp::Expression<double> r = u * u * u + 3.0 * u - 1.0;
+        if (i > 0) {
+            r = r - symcpp::Expression<double>(chain[i - 1]);
+        }
+        if (i + 1 < n) {
+            r = r - symcpp::Expression<double>(chain[i + 1]);
+        }
+        residuals.push_back(r);
+    }
+    symcpp::SystemSolver<double> solver(residuals, unknowns);
+    auto solution = solver.solve(std::vector<double>(n, 0.0));
+    ASSERT_EQ(solution.status, symcpp::RootStatus::Converged);
+    std::map<std::string, double> point;
+    for (size_t j = 0; j < n; ++j) {
+        point[unknowns[j]] = solution.x[j];
+    }
+    for (const auto& r : residuals) {
+        EXPECT_NEAR(r.eval(point), 0, 1e-9);
+    }
+}
+
+TEST(IntegratorTest, SmoothIntegrandConverges) {
+    auto sine = symcpp::parse_expression<double>("sin(x)");
+    symcpp::Integrator<double> integrator(sine, {"x"});
+    auto result = integrator.integrate(0.0, std::acos(-1.0));
+    EXPECT_TRUE(result.converged);
+    EXPECT_NEAR(result.value, 2, 1e-12);
+    EXPECT_EQ(integrator.integrate(1.0, 1.0).value, 0);
+}
+
+TEST(IntegratorTest, EndpointSingularityNeedsSubdivision) {
+    auto root = symcpp::parse_expression<double>("x ^ 0.5");
+    auto sqrt = symcpp::Integrator<double>(root, {"x"}).integrate(0.0, 1.0);
+    EXPECT_TRUE(sqrt.converged);
+    EXPECT_NEAR(sqrt.value, 2.0 / 3.0, 1e-9);
+    EXPECT_GT(sqrt.evaluations, 15u);
+}
+
+TEST(IntegratorTest, NestedIntegralWithParameter) {
+    auto surface = symcpp::parse_expression<double>("a * x * y ^ 2");
+    symcpp::Integrator<double> nested(surface, {"x", "y"});
+    auto volume = nested.integrate({0.0, 0.0}, {1.0, 2.0}, {{"a", 3.0}});
+    EXPECT_TRUE(volume.converged);
+    EXPECT_NEAR(volume.value, 4, 1e-10);
+    EXPECT_THROW(nested.integrate({0.0}, {1.0}, {{"a", 3.0}}),
+                 std::runtime_error);
+    EXPECT_THROW(nested.integrate({0.0, 0.0}, {1.0, 2.0}),
+                 std::runtime_error);
+}
+
+TEST(IntegratorTest, ComplexIntegrand) {
+    using Complex = std::complex<long double>;
+    auto wave = symcpp::parse_expression<Complex>("exp(k * t)");
+    symcpp::Integrator<Complex> oscillating(wave, {"t"});
+    auto phase = oscillating.integrate(0.0L, 1.0L, {{"k", Complex(0, 1)}});
+    EXPECT_TRUE(phase.converged);
+    EXPECT_NEAR(static_cast<double>(phase.value.real()), std::sin(1.0),
+                1e-12);
+    EXPECT_NEAR(static_cast<double>(phase.value.imag()), 1 - std::cos(1.0),
+                1e-12);
+}
+
+TEST(OdeTest, RosenbrockTakesFewerStepsOnStiffProblem) {
+    auto relax = symcpp::parse_expression<double>("k * (cos(t) - y)");
+    symcpp::OdeOptions options;
+    options.absolute_tolerance = options.relative_tolerance = 1e-4;
+    symcpp::OdeSystem<double> explicit_solver({relax}, {"y"}, "t", options);
+    options.method = symcpp::OdeMethod::Rosenbrock;
+    symcpp::OdeSystem<double> implicit_solver({relax}, {"y"}, "t", options);
+    double k = 1000;
+    double expected = (k * k * std::cos(10.0) + k * std::sin(10.0)) /
+                      (k * k + 1);
+    auto stiff = implicit_solver.integrate({0.0}, 0, 10, {{"k", k}});
+    auto nonstiff = explicit_solver.integrate({0.0}, 0, 10, {{"k", k}});
+    EXPECT_TRUE(stiff.success);
+    EXPECT_TRUE(nonstiff.success);
+    EXPECT_NEAR(stiff.y[0], expected, 1e-3);
+    EXPECT_NEAR(nonstiff.y[0], expected, 1e-3);
+    EXPECT_LT(stiff.steps * 5, nonstiff.steps);
+}
+
+TEST(OdeTest, OnlyRosenbrockDifferentiatesTheRightHandSide) {
+    using symcpp::allocation::Operation;
+    ASSERT_TRUE(symcpp::allocation::installed());
+    auto rhs = symcpp::parse_expression<double>("k * (cos(t) - y)");
+    symcpp::OdeOptions options;
+    symcpp::allocation::reset();
+    symcpp::allocation::enable();
+    symcpp::OdeSystem<double> explicit_solver({rhs}, {"y"}, "t", options);
+    auto after_explicit = symcpp::allocation::usage(Operation::Diff);
+    options.method = symcpp::OdeMethod::Rosenbrock;
+    symcpp::OdeSystem<double> implicit_solver({rhs}, {"y"}, "t", options);
+    symcpp::allocation::enable(false);
+    EXPECT_EQ(after_explicit.allocations, 0u);
+    EXPECT_GT(symcpp::allocation::usage(Operation::Diff).allocations, 0u);
+
+    auto fast = explicit_solver.integrate({0.0}, 0, 1, {{"k", 2.0}});
+    auto stiff = implicit_solver.integrate({0.0}, 0, 1, {{"k", 2.0}});
+    EXPECT_TRUE(fast.success);
+    EXPECT_TRUE(stiff.success);
+    EXPECT_NEAR(fast.y[0], stiff.y[0], 1e-4);
+}
+
+TEST(OdeTest, IntegratesBackwardInTime) {
+    auto decay = symcpp::parse_expression<double>("-y");
+    symcpp::OdeOptions options;
+    options.absolute_tolerance = options.relative_tolerance = 1e-10;
+    symcpp::OdeSystem<double> solver({decay}, {"y"}, "t", options);
+    auto back = solver.integrate({1.0}, 2, 0);
+    EXPECT_TRUE(back.success);
+    EXPECT_NEAR(back.y[0], std::exp(2.0), 1e-7);
+    auto still = solver.integrate({1.0}, 1, 1);
+    EXPECT_TRUE(still.success);
+    EXPECT_EQ(still.y[0], 1);
+    EXPECT_THROW(solver.integrate({1.0, 2.0}, 0, 1), std::runtime_error);
+}
+
+TEST(OdeTest, BatchMatchesAnalyticOscillator) {
+    auto x = symcpp::parse_expression<double>("v");
+    auto v = symcpp::parse_expression<double>("-(w ^ 2) * x");
+    symcpp::OdeOptions options;
+    options.absolute_tolerance = options.relative_tolerance = 1e-10;
+    symcpp::OdeSystem<double> oscillator({x, v}, {"x", "v"}, "t", options);
+    size_t count = 64;
+    std::vector<double> initial(2 * count), final_states(2 * count);
+    for (size_t p = 0; p < count; ++p) {
+        initial[2 * p] = std::cos(0.1 * p);
+        initial[2 * p + 1] = std::sin(0.1 * p);
+    }
+    std::vector<char> success(count);
+    oscillator.integrate_batch(initial.data(), count, 0, 3, {{"w", 2.0}},
+                               final_states.data(),
+                               reinterpret_cast<bool*>(success.data()));
+    for (size_t p = 0; p < count; ++p) {
+        EXPECT_TRUE(success[p]);
+        double x0 = initial[2 * p];
+        double v0 = initial[2 * p + 1];
+        EXPECT_NEAR(final_states[2 * p],
+                    x0 * std::cos(6.0) + v0 / 2 * std::sin(6.0), 1e-7);
+    }
+}
+
+TEST(MinimizerTest, UnconstrainedRosenbrock) {
+    auto objective = symcpp::parse_expression<symcpp::Reals_t>(
+        "(a - x) ^ 2 + 100 * (y - x ^ 2) ^ 2");
+    symcpp::Minimizer<> minimizer(objective, {"x", "y"});
+    EXPECT_EQ(minimizer.parameters(), std::vector<std::string>{"a"});
+
+    auto free = minimizer.minimize({-1.2L, 1.0L}, {}, {}, {{"a", 1.0L}});
+    EXPECT_EQ(free.status, symcpp::RootStatus::Converged);
+    EXPECT_NEAR(static_cast<double>(free.x[0]), 1, 1e-6);
+    EXPECT_NEAR(static_cast<double>(free.x[1]), 1, 1e-6);
+    EXPECT_LT(free.iterations, 100u);
+}
+
+TEST(MinimizerTest, ActiveBoundStopsOnFace) {
+    auto objective = symcpp::parse_expression<symcpp::Reals_t>(
+        "(a - x) ^ 2 + 100 * (y - x ^ 2) ^ 2");
+    symcpp::Minimizer<> minimizer(objective, {"x", "y"});
+    symcpp::Minimizer<>::Workspace workspace;
+    auto bounded = minimizer.minimize({-1.2L, 1.0L}, {-2.0L, -2.0L},
+                                      {0.5L, 2.0L}, {{"a", 1.0L}},
+                                      &workspace);
+    EXPECT_EQ(bounded.status, symcpp::RootStatus::Converged);
+    EXPECT_NEAR(static_cast<double>(bounded.x[0]), 0.5, 1e-9);
+    EXPECT_NEAR(static_cast<double>(bounded.x[1]), 0.25, 1e-6);
+
+    auto again = minimizer.minimize({-1.2L, 1.0L}, {-2.0L, -2.0L},
+                                    {0.5L, 2.0L}, {{"a", 1.0L}},
+                                    &workspace);
+    EXPECT_EQ(again.x, bounded.x);
+    EXPECT_THROW(minimizer.minimize({-1.2L, 1.0L}, {-2.0L}, {0.5L},
+                                    {{"a", 1.0L}}),
+                 std::runtime_error);
+}
+
+TEST(MinimizerTest, ShortHistoryOnNonconvexObjective) {
+    auto objective = symcpp::parse_expression<symcpp::Reals_t>(
+        "x ^ 4 - 3 * x ^ 2 + y ^ 4 - 2 * y ^ 2 + x * y + sin(3 * x)");
+    symcpp::MinimizerOptions options;
+    options.history = 2;
+    options.value_tolerance = 0;
+    symcpp::Minimizer<> minimizer(objective, {"x", "y"}, options);
+    for (auto [x, y] : {std::pair{0.1L, 0.2L}, {2.0L, -1.5L}, {-0.3L, 1.7L}}) {
+        auto result = minimizer.minimize({x, y});
+        EXPECT_EQ(result.status, symcpp::RootStatus::Converged);
+        EXPECT_LE(result.gradient_norm, 1e-8L);
+        EXPECT_LT(result.iterations, 200u);
+    }
+}
+
+TEST(SeriesTest, ExponentialMatchesTaylorPolynomial) {
+    auto exp = symcpp::series(symcpp::parse_expression<double>("exp(x)"),
+                              "x", 0.0, 5);
+    EXPECT_NEAR(exp.eval({{"x", 0.5}}),
+                1 + 0.5 + 0.125 + 0.125 / 6 + 0.0625 / 24 + 0.03125 / 120,
+                1e-15);
+    auto constant = symcpp::series(
+        symcpp::parse_expression<double>("exp(x)"), "x", 0.0, 0);
+    EXPECT_EQ(constant.eval({{"x", 0.5}}), 1);
+}
+
+TEST(SeriesTest, RemovableSingularity) {
+    auto sinc = symcpp::series(
+        symcpp::parse_expression<double>("sin(x) / x"), "x", 0.0, 6);
+    EXPECT_NEAR(sinc.eval({{"x", 0.3}}), std::sin(0.3) / 0.3, 1e-9);
+}
+
+TEST(SeriesTest, ExpansionAroundNonzeroPoint) {
+    auto root = symcpp::series(
+        symcpp::parse_expression<double>("(1 + x) ^ 0.5 * cos(x)"), "x",
+        3.0, 8);
+    EXPECT_NEAR(root.eval({{"x", 3.1}}), 2.0248456731316587 * std::cos(3.1),
+                1e-11);
+}
+
+TEST(SeriesTest, PolynomialIsReproducedExactly) {
+    auto cubic = symcpp::series(
+        symcpp::parse_expression<double>("(x + 1) ^ 3"), "x", 2.0, 5);
+    EXPECT_DOUBLE_EQ(cubic.eval({{"x", -4}}), -27);
+}
+
+TEST(SeriesTest, KeepsOtherVariablesSymbolic) {
+    auto scaled = symcpp::series(
+        symcpp::parse_expression<double>("ln(a + x)"), "x", 0.0, 3);
+    EXPECT_EQ(scaled.variables(), (std::set<std::string>{"a", "x"}));
+    EXPECT_NEAR(scaled.eval({{"x", 0.01}, {"a", 2}}),
+                std::log(2) + 0.005 - 0.0000125 + 0.01 * 0.01 * 0.01 / 24,
+                1e-12);
+}
+
+TEST(SeriesTest, RejectsBranchPoint) {
+    EXPECT_THROW(symcpp::series(symcpp::parse_expression<double>("x ^ 0.5"),
+                                "x", 0.0, 3),
+                 std::runtime_error);
+    EXPECT_THROW(symcpp::series(symcpp::parse_expression<double>("ln(x)"),
+                                "x", 0.0, 3),
+                 std::runtime_error);
+}
+
+TEST(SeriesTest, DivisionWithLargeCommonShift) {
+    auto quotient = symcpp::series(
+        symcpp::parse_expression<double>("sin(x) ^ 5 / x ^ 5"), "x", 0.0, 4);
+    double x = 0.1;
+    EXPECT_NEAR(quotient.eval({{"x", x}}),
+                1 - 5 * x * x / 6 + 23 * x * x * x * x / 72, 1e-15);
+    EXPECT_NEAR(quotient.eval({{"x", x}}), std::pow(std::sin(x) / x, 5),
+                1e-7);
+
+    auto nested = symcpp::series(
+        symcpp::parse_expression<double>(
+            "(sin(x) ^ 3 / x ^ 3) / (x ^ 3 / sin(x) ^ 3)"),
+        "x", 0.0, 4);
+    EXPECT_NEAR(nested.eval({{"x", x}}), std::pow(std::sin(x) / x, 6),
+                1e-6);
+}
+
+TEST(AdaptiveSamplerTest, RefinesCurvatureWithinTolerance) {
+    auto wave = symcpp::parse_expression<double>("sin(a * x)");
+    symcpp::AdaptiveSampler<double> sampler(wave, "x");
+    auto curve = sampler.sample(0, 10, {{"a", 3.0}});
+    EXPECT_LT(curve.evaluations, 5000u);
+    EXPECT_LT(curve.points.size(), curve.evaluations);
+    for (size_t i = 0; i + 1 < curve.points.size(); ++i) {
+        const auto& p = curve.points[i];
+        const auto& q = curve.points[i + 1];
+        ASSERT_TRUE(p.valid);
+        ASSERT_LT(p.x, q.x);
+        double x = p.x / 2 + q.x / 2;
+        EXPECT_NEAR((p.y + q.y) / 2, std::sin(3 * x), 4e-3);
+    }
+}
+
+TEST(AdaptiveSamplerTest, MarksPoleWithSingleGap) {
+    auto pole = symcpp::parse_expression<double>("1 / (x - 0.3)");
+    auto broken = symcpp::AdaptiveSampler<double>(pole, "x").sample(0, 1);
+    size_t gaps = 0;
+    for (const auto& point : broken.points) {
+        if (!point.valid) {
+            ++gaps;
+            EXPECT_NEAR(point.x, 0.3, 1e-3);
+        }
+    }
+    EXPECT_EQ(gaps, 1u);
+}
+
+TEST(AdaptiveSamplerTest, LocatesDomainBoundary) {
+    auto log = symcpp::parse_expression<double>("ln(x)");
+    symcpp::AdaptiveSampler<double> sampler(log, "x");
+    auto half = sampler.sample(-1, 1);
+    auto first = std::find_if(half.points.begin(), half.points.end(),
+                              [](const auto& p) { return p.valid; });
+    ASSERT_NE(first, half.points.end());
+    EXPECT_LT(first->x, 1e-3);
+
+    auto outside = sampler.sample(-2, -1);
+    EXPECT_TRUE(std::none_of(outside.points.begin(), outside.points.end(),
+                             [](const auto& p) { return p.valid; }));
+    EXPECT_THROW(sampler.sample(1, 1), std::runtime_error);
+    EXPECT_THROW(symcpp::AdaptiveSampler<double>(
+                     symcpp::parse_expression<double>("a * x"), "x")
+                     .sample(0, 1),
+                 std::runtime_error);
+}
+
+TEST(AdaptiveSamplerTest, DeepLimitStopsAtFloatingResolution) {
+    auto step = symcpp::parse_expression<double>(
+        "(x - 0.3) / ((x - 0.3) ^ 2) ^ 0.5");
+    symcpp::SamplingOptions options;
+    options.max_depth = 300;
+    options.compact = false;
+    auto curve = symcpp::AdaptiveSampler<double>(step, "x", options)
+                     .sample(0, 1);
+    EXPECT_LT(curve.evaluations, 1000u);
+    for (size_t i = 0; i + 1 < curve.points.size(); ++i) {
+        ASSERT_LT(curve.points[i].x, curve.points[i + 1].x);
+    }
+    auto closest = std::min_element(
+        curve.points.begin(), curve.points.end(),
+        [](const auto& p, const auto& q) {
+            return std::fabs(p.x - 0.3) < std::fabs(q.x - 0.3);
+        });
+    EXPECT_LT(std::fabs(closest->x - 0.3), 1e-15);
+}
+
+TEST(GlobalMinimizerTest, CertifiesSixHumpCamel) {
+    auto camel = symcpp::parse_expression<double>(
+        "4 * x ^ 2 - 2.1 * x ^ 4 + x ^ 6 / 3 + x * y - 4 * y ^ 2 + "
+        "4 * y ^ 4");
+    symcpp::GlobalOptions options;
+    options.tolerance = 1e-6;
+    symcpp::GlobalMinimizer<double> minimizer(camel, {"x", "y"}, options);
+    auto result = minimizer.minimize({-3, -2}, {3, 2});
+    EXPECT_TRUE(result.converged);
+    EXPECT_NEAR(result.value, -1.0316284534898774, 1e-9);
+    EXPECT_NEAR(std::fabs(result.x[0]), 0.0898420131, 1e-5);
+    EXPECT_NEAR(std::fabs(result.x[1]), 0.7126564030, 1e-5);
+    EXPECT_LE(result.lower_bound, result.value);
+    EXPECT_GE(result.lower_bound, result.value - 1e-6);
+    EXPECT_THROW(minimizer.minimize({-3}, {3}), std::runtime_error);
+}
+
+TEST(GlobalMinimizerTest, ParameterSelectsDistantWell) {
+    auto wells = symcpp::parse_expression<double>("x ^ 2 / a - cos(5 * x)");
+    symcpp::GlobalOptions options;
+    options.tolerance = 1e-6;
+    symcpp::GlobalMinimizer<double> shifted(wells, {"x"}, options);
+    auto well = shifted.minimize({0.5}, {4}, {{"a", 10.0}});
+    EXPECT_TRUE(well.converged);
+    EXPECT_NEAR(well.x[0], 2 * std::acos(-1.0) / 5, 2e-2);
+    EXPECT_GT(well.x[0], 1.2);
+    EXPECT_THROW(shifted.minimize({0.5}, {4}), std::runtime_error);
+}
+
+TEST(MonteCarloTest, InverseNormalQuantiles) {
+    EXPECT_NEAR(symcpp::inverse_normal(0.975), 1.959963984540054, 1e-12);
+    EXPECT_NEAR(symcpp::inverse_normal(0.5), 0, 1e-15);
+    EXPECT_NEAR(symcpp::inverse_normal(1e-10),
+                -symcpp::inverse_normal(1 - 1e-10), 1e-6);
+}
+
+TEST(MonteCarloTest, StatisticsDoNotDependOnThreadCount) {
+    auto square = symcpp::parse_expression<double>("x ^ 2");
+    symcpp::MonteCarloOptions options;
+    options.seed = 42;
+    options.threads = 4;
+    symcpp::MonteCarlo<double> uniform(
+        square, {{"x", symcpp::Distribution::uniform(0, 1)}}, options);
+    auto result = uniform.run(200000);
+    EXPECT_EQ(result.samples, 200000u);
+    EXPECT_NEAR(result.mean, 1.0 / 3, 3e-3);
+    EXPECT_NEAR(result.variance, 4.0 / 45, 3e-3);
+    EXPECT_NEAR(result.quantiles[1], 0.25, 3e-3);
+    options.threads = 1;
+    auto serial = symcpp::MonteCarlo<double>(
+                      square, {{"x", symcpp::Distribution::uniform(0, 1)}},
+                      options)
+                      .run(200000);
+    EXPECT_NEAR(serial.mean, result.mean, 1e-12);
+    EXPECT_EQ(serial.quantiles, result.quantiles);
+}
+
+TEST(MonteCarloTest, CountsSamplesOutsideDomain) {
+    auto affine = symcpp::parse_expression<double>("a * z + ln(y)");
+    symcpp::MonteCarloOptions options;
+    options.seed = 42;
+    options.threads = 1;
+    symcpp::MonteCarlo<double> normal(
+        affine,
+        {{"z", symcpp::Distribution::normal(1, 1)},
+         {"y", symcpp::Distribution::uniform(-1, 1)}},
+        options);
+    auto shifted = normal.run(100000, {{"a", 2.0}});
+    EXPECT_NEAR(static_cast<double>(shifted.failures), 50000, 1000);
+    EXPECT_EQ(shifted.samples + shifted.failures, 100000u);
+    EXPECT_NEAR(shifted.mean, 2 - 1, 3e-2);
+    EXPECT_THROW(normal.run(10), std::runtime_error);
+}
+
+TEST(MonteCarloTest, SobolPointsStratifyEveryDimension) {
+    symcpp::Sobol sobol(3);
+    std::vector<std::vector<int>> hits(3, std::vector<int>(1024));
+    uint32_t point[3];
+    for (uint64_t i = 0; i < 1024; ++i) {
+        sobol.point(i, point);
+        for (size_t d = 0; d < 3; ++d) {
+            ++hits[d][point[d] >> 22];
+        }
+    }
+    for (const auto& dimension : hits) {
+        EXPECT_EQ(std::count(dimension.begin(), dimension.end(), 1), 1024);
+    }
+    EXPECT_THROW(symcpp::Sobol(1000), std::runtime_error);
+}
+
+TEST(MonteCarloTest, SobolEstimateConvergesFaster) {
+    symcpp::MonteCarloOptions options;
+    options.seed = 42;
+    options.threads = 1;
+    options.sobol = true;
+    auto product = symcpp::parse_expression<double>("x * y");
+    auto quasi = symcpp::MonteCarlo<double>(
+                     product,
+                     {{"x", symcpp::Distribution::uniform(0, 1)},
+                      {"y", symcpp::Distribution::uniform(0, 1)}},
+                     options)
+                     .run(4095);
+    EXPECT_NEAR(quasi.mean, 0.25, 1e-3);
+}
+
+TEST(ChebyshevTest, SmoothFunctionWithinTolerance) {
+    auto expr =
+        symcpp::parse_expression<double>("exp(sin(a * x)) + ln(2 + x)");
+    auto proxy =
+        symcpp::approximate(expr, "x", 0.0, 5.0, 1e-10, {{"a", 3.0}});
+    EXPECT_LE(proxy.error(), 1e-10);
+    EXPECT_LE(proxy.degree(), 64u);
+    for (int i = 0; i <= 1000; ++i) {
+        double x = 5.0 * i / 1000;
+        double exact = std::exp(std::sin(3 * x)) + std::log(2 + x);
+        ASSERT_NEAR(proxy(x), exact, 1e-9);
+    }
+}
+
+TEST(ChebyshevTest, SplitsNearLogarithmicGrowth) {
+    auto log = symcpp::parse_expression<double>("ln(x)");
+    auto piecewise = symcpp::approximate(log, "x", 1e-4, 1.0, 1e-8);
+    EXPECT_GT(piecewise.pieces(), 1u);
+    std::vector<double> xs{1e-4, 3e-4, 0.01, 0.5, 1.0}, out(xs.size());
+    piecewise.eval_batch(xs.data(), xs.size(), out.data());
+    for (size_t i = 0; i < xs.size(); ++i) {
+        EXPECT_NEAR(out[i], std::log(xs[i]), 1e-7);
+    }
+}
+
+TEST(ChebyshevTest, RejectsInvalidIntervals) {
+    auto log = symcpp::parse_expression<double>("ln(x)");
+    EXPECT_THROW(symcpp::approximate(log, "x", -1.0, 1.0, 1e-8),
+                 std::runtime_error);
+    EXPECT_THROW(symcpp::approximate(log, "x", 1.0, 1.0, 1e-8),
+                 std::runtime_error);
+    EXPECT_THROW(symcpp::approximate(log, "x", 2.0, 1.0, 1e-8),
+                 std::runtime_error);
+}
+
+TEST(CurveFitterTest, RecoversParametersFromData) {
+    auto model = symcpp::parse_expression<double>("a * exp(-k * t) + c");
+    size_t rows = 10000;
+    std::vector<double> t(rows), y(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        t[r] = 5.0 * r / rows;
+        y[r] = 2.5 * std::exp(-1.3 * t[r]) + 0.4 +
+               1e-3 * std::sin(37.0 * r);
+    }
+    const double* columns[] = {t.data()};
+    symcpp::FitOptions options;
+    options.threads = 4;
+    symcpp::CurveFitter<double> fitter(model, {"a", "k", "c"}, {"t"},
+                                       options);
+    auto fit = fitter.fit({1.0, 0.5, 0.0}, columns, y.data(), rows);
+    EXPECT_EQ(fit.status, symcpp::RootStatus::Converged);
+    EXPECT_NEAR(fit.parameters[0], 2.5, 1e-3);
+    EXPECT_NEAR(fit.parameters[1], 1.3, 1e-3);
+    EXPECT_NEAR(fit.parameters[2], 0.4, 1e-3);
+    EXPECT_LT(fit.cost, 1e-5 * static_cast<double>(rows));
+
+    options.threads = 1;
+    symcpp::CurveFitter<double> serial(model, {"a", "k", "c"}, {"t"},
+                                       options);
+    auto same = serial.fit({1.0, 0.5, 0.0}, columns, y.data(), rows);
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_NEAR(same.parameters[i], fit.parameters[i], 1e-8);
+    }
+}
+
+TEST(CurveFitterTest, RejectsUnboundModelVariables) {
+    auto model = symcpp::parse_expression<double>("a * exp(-k * t) + c");
+    EXPECT_THROW(symcpp::CurveFitter<double>(model, {"a", "k"}, {"t"}),
+                 std::runtime_error);
+    EXPECT_THROW(symcpp::CurveFitter<double>(model, {"a", "k", "c"}, {}),
+                 std::runtime_error);
+    EXPECT_NO_THROW(
+        symcpp::CurveFitter<double>(model, {"a", "k", "c"}, {"t", "s"}));
+}
+
+TEST(CurveFitterTest, RejectsTrialStepsOutsideModelDomain) {
+    auto model = symcpp::parse_expression<double>("a * ln(k + t)");
+    size_t rows = 200;
+    std::vector<double> t(rows), y(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        t[r] = 5.0 * r / rows;
+        y[r] = 2.0 * std::log(0.05 + t[r]);
+    }
+    const double* columns[] = {t.data()};
+    symcpp::CurveFitter<double> fitter(model, {"a", "k"}, {"t"});
+    for (double k : {2.0, 10.0}) {
+        auto fit = fitter.fit({1.0, k}, columns, y.data(), rows);
+        EXPECT_EQ(fit.status, symcpp::RootStatus::Converged) << k;
+        EXPECT_NEAR(fit.parameters[0], 2.0, 1e-6) << k;
+        EXPECT_NEAR(fit.parameters[1], 0.05, 1e-6) << k;
+    }
+    EXPECT_THROW(fitter.fit({1.0, -1.0}, columns, y.data(), rows),
+                 std::runtime_error);
+}
+
+TEST(GeneratorTest, VariableNamesUseSpreadsheetOrder) {
+    EXPECT_EQ(symcpp::ExpressionGenerator<>::variable_name(0), "a");
+    EXPECT_EQ(symcpp::ExpressionGenerator<>::variable_name(25), "z");
+    EXPECT_EQ(symcpp::ExpressionGenerator<>::variable_name(26), "aa");
+    EXPECT_EQ(symcpp::ExpressionGenerator<>::variable_name(27), "ab");
+}
+
+TEST(GeneratorTest, EveryShapeIsDeterministicAndParseable) {
+    for (const char* shape : {"random", "sum", "nested", "polynomial",
+                              "trig"}) {
+        symcpp::GeneratorOptions options;
+        options.size = 40;
+        options.variables = 6;
+        options.sharing = 0.2;
+        options.shape = symcpp::shape_from_name(shape);
+        symcpp::ExpressionGenerator<double> texts(options, 7);
+        symcpp::ExpressionGenerator<double> again(options, 7);
+        symcpp::ExpressionGenerator<double> objects(options, 7);
+        ASSERT_EQ(texts.variables().size(), 6u);
+        std::map<std::string, double> values;
+        for (size_t v = 0; v < texts.variables().size(); ++v) {
+            values[texts.variables()[v]] = 0.1 + 0.13 * v;
+        }
+        for (int i = 0; i < 5; ++i) {
+            std::string text = texts.text();
+            EXPECT_EQ(text, again.text());
+            auto parsed = symcpp::parse_expression<double>(text);
+            auto built = objects.expression();
+            double expected = parsed.eval(values);
+            EXPECT_TRUE(std::isfinite(expected)) << shape << ": " << text;
+            EXPECT_NEAR(built.eval(values), expected,
+                        1e-9 * (1 + std::fabs(expected)))
+                << shape;
+        }
+    }
+}
+
+TEST(GeneratorTest, SeedsDifferAndInvalidOptionsThrow) {
+    symcpp::GeneratorOptions options;
+    EXPECT_NE(symcpp::ExpressionGenerator<>(options, 1).text(),
+              symcpp::ExpressionGenerator<>(options, 2).text());
+    EXPECT_THROW(symcpp::shape_from_name("spiral"), std::runtime_error);
+    options.variables = 0;
+    EXPECT_THROW(symcpp::ExpressionGenerator<>(options, 1),
+                 std::runtime_error);
+}
+
+TEST(AllocationTest, AttributesAllocationsToOperations) {
+    using symcpp::allocation::Operation;
+    ASSERT_TRUE(symcpp::allocation::installed());
+    symcpp::allocation::reset();
+    symcpp::allocation::enable();
+    auto expr = symcpp::parse_expression<double>("sin(x) * y + ln(x) ^ 2");
+    auto derivative = expr.diff("x");
+    auto built = symcpp::Expression<double>("x") + 1.0;
+    std::string text = derivative.to_string();
+    symcpp::CompiledExpression<double> compiled(derivative);
+    symcpp::allocation::enable(false);
+
+    for (auto operation : {Operation::Parse, Operation::Build,
+                           Operation::Diff, Operation::ToString,
+                           Operation::Compile}) {
+        EXPECT_GT(symcpp::allocation::usage(operation).allocations, 0u)
+            << symcpp::allocation::operation_name(operation);
+    }
+    EXPECT_GT(symcpp::allocation::usage(symcpp::NodeKind::Sin).bytes, 0u);
+    EXPECT_GT(symcpp::allocation::usage(symcpp::NodeKind::Variable).bytes,
+              0u);
+    auto total = symcpp::allocation::total();
+    EXPECT_GE(total.allocations, total.frees);
+}
+
+TEST(AllocationTest, WarmBatchEvaluationDoesNotAllocate) {
+    using symcpp::allocation::Operation;
+    ASSERT_TRUE(symcpp::allocation::installed());
+    auto expr = symcpp::parse_expression<double>("sin(x) * y + ln(x) ^ 2");
+    symcpp::CompiledExpression<double> compiled(expr.diff("x"));
+    std::vector<double> xs(1000, 1.5), ys(1000, 0.5), out(1000);
+    std::vector<const double*> columns;
+    for (const auto& name : compiled.variables()) {
+        columns.push_back(name == "x" ? xs.data() : ys.data());
+    }
+    double* results[] = {out.data()};
+    symcpp::CompiledExpression<double>::Workspace workspace;
+
+    symcpp::allocation::reset();
+    symcpp::allocation::enable();
+    compiled.eval_batch(columns.data(), 1000, results, workspace);
+    auto warm = symcpp::allocation::usage(Operation::Eval);
+    compiled.eval_batch(columns.data(), 1000, results, workspace);
+    double value = expr.eval({{"x", 1.5}, {"y", 0.5}});
+    symcpp::allocation::enable(false);
+
+    EXPECT_GT(warm.allocations, 0u);
+    auto eval = symcpp::allocation::usage(Operation::Eval);
+    EXPECT_EQ(eval.allocations, warm.allocations);
+    EXPECT_EQ(eval.bytes, warm.bytes);
+    EXPECT_NEAR(value, std::sin(1.5) * 0.5 + std::pow(std::log(1.5), 2),
+                1e-12);
+}
+
+TEST(AllocationTest, DisabledCountersStayUnchanged) {
+    ASSERT_TRUE(symcpp::allocation::installed());
+    symcpp::allocation::reset();
+    symcpp::allocation::enable(false);
+    symcpp::parse_expression<double>("x + y").diff("x").to_string();
+    auto total = symcpp::allocation::total();
+    EXPECT_EQ(total.allocations, 0u);
+    EXPECT_EQ(total.frees, 0u);
+}
+
+TEST(AllocationTest, ReportListsOperationsAndKinds) {
+    symcpp::allocation::reset();
+    std::ostringstream report;
+    symcpp::allocation::report(report);
+    EXPECT_NE(report.str().find("to_string"), std::string::npos);
+    EXPECT_NE(report.str().find("Power"), std::string::npos);
+    EXPECT_NE(report.str().find("freed bytes"), std::string::npos);
+}
+
+TEST(AllocationTest, CountsFreesPerNodeKind) {
+    ASSERT_TRUE(symcpp::allocation::installed());
+    symcpp::allocation::reset();
+    symcpp::allocation::enable();
+    {
+        auto expr = symcpp::parse_expression<double>("sin(x) + cos(y)");
+        auto derivative = expr.diff("x");
+    }
+    symcpp::allocation::enable(false);
+
+    for (auto kind : {symcpp::NodeKind::Sin, symcpp::NodeKind::Cos,
+                      symcpp::NodeKind::Variable}) {
+        auto usage = symcpp::allocation::usage(kind);
+        EXPECT_GT(usage.frees, 0u) << symcpp::node_kind_name(kind);
+        EXPECT_EQ(usage.frees, usage.allocations)
+            << symcpp::node_kind_name(kind);
+        EXPECT_EQ(usage.freed_bytes, usage.bytes)
+            << symcpp::node_kind_name(kind);
+    }
+}
+
+TEST(ProfilingEvaluatorTest, CountsSharedNodesPerVisit) {
+    symcpp::Expression<double> x("x"), y("y");
+    auto shared = x.sin() * y;
+    auto expr = shared + shared * shared + (1.0 + x * x).ln() / y.exp();
+    symcpp::ProfilingEvaluator<double> profiler(expr, 4);
+    for (int i = 0; i < 1000; ++i) {
+        std::map<std::string, double> values{{"x", 0.001 * i}, {"y", 0.5}};
+        ASSERT_DOUBLE_EQ(profiler.eval(values), expr.eval(values));
+    }
+    EXPECT_EQ(profiler.calls(), 1000u);
+
+    for (const auto& node : profiler.hottest()) {
+        if (node.expr.id() == shared.id()) {
+            EXPECT_EQ(node.evaluations, 3000u);
+        }
+        if (node.expr.id() == expr.id()) {
+            EXPECT_EQ(node.evaluations, 1000u);
+        }
+    }
+    for (const auto& kind : profiler.kinds()) {
+        if (kind.kind == symcpp::NodeKind::Sin) {
+            EXPECT_EQ(kind.evaluations, 3000u);
+        }
+        if (kind.kind == symcpp::NodeKind::Ln) {
+            EXPECT_EQ(kind.evaluations, 1000u);
+        }
+    }
+}
+
+TEST(ProfilingEvaluatorTest, SortsNodesBySelfTime) {
+    symcpp::Expression<double> x("x");
+    auto expr = (x.sin() * x.cos()).exp() + x * x;
+    symcpp::ProfilingEvaluator<double> profiler(expr, 1);
+    for (int i = 0; i < 1000; ++i) {
+        profiler.eval({{"x", 0.001 * i}});
+    }
+    auto nodes = profiler.hottest();
+    double total = 0;
+    for (const auto& node : nodes) {
+        EXPECT_GE(node.seconds, node.self_seconds);
+        total += node.self_seconds;
+        if (node.expr.id() == expr.id()) {
+            EXPECT_GT(node.seconds, 0);
+        }
+    }
+    EXPECT_GT(total, 0);
+    for (size_t i = 1; i < nodes.size(); ++i) {
+        EXPECT_GE(nodes[i - 1].self_seconds, nodes[i].self_seconds);
+    }
+}
+
+TEST(ProfilingEvaluatorTest, ReportAndReset) {
+    auto expr = symcpp::parse_expression<double>("sin(x) / y");
+    symcpp::ProfilingEvaluator<double> profiler(expr, 2);
+    for (int i = 0; i < 10; ++i) {
+        profiler.eval({{"x", 0.1 * i}, {"y", 2.0}});
+    }
+    std::ostringstream report;
+    profiler.report(report, 3);
+    EXPECT_NE(report.str().find("Sin"), std::string::npos);
+    EXPECT_NE(report.str().find("subexpression"), std::string::npos);
+
+    profiler.reset();
+    EXPECT_EQ(profiler.calls(), 0u);
+    for (const auto& node : profiler.hottest()) {
+        EXPECT_EQ(node.evaluations, 0u);
+    }
+    EXPECT_THROW(profiler.eval({{"x", 1.0}}), std::runtime_error);
+    EXPECT_THROW(profiler.eval({{"x", 1.0}, {"y", 0.0}}),
+                 std::runtime_error);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,93 @@
+#include <cxxopts.hpp>
+#include <iostream>
+#include <string>
+
+#include "generator.hpp"
+
+int main(int argc, char* argv[]) {
+    cxxopts::Options options("generate",
+                             "Generate random expressions for benchmarks and "
+                             "stress tests, one per line");
+
+    options.add_options()("s,seed", "Random seed",
+                          cxxopts::value<uint64_t>()->default_value("0"))(
+        "n,count", "Number of expressions",
+        cxxopts::value<size_t>()->default_value("1"))(
+        "size", "Operators per expression (terms for sum and polynomial)",
+        cxxopts::value<size_t>()->default_value("64"))(
+        "depth", "Maximum nesting depth",
+        cxxopts::value<size_t>()->default_value("64"))(
+        "variables", "Number of distinct variables",
+        cxxopts::value<size_t>()->default_value("4"))(
+        "shape", "random, sum, nested, polynomial or trig",
+        cxxopts::value<std::string>()->default_value("random"))(
+        "sharing", "Probability of reusing an earlier subexpression",
+        cxxopts::value<double>()->default_value("0"))(
+        "constants", "Probability that a leaf is a constant",
+        cxxopts::value<double>()->default_value("0.25"))(
+        "weights",
+        "Operator weights as KIND=W pairs, e.g. Add=4,Divide=0,Sin=2",
+        cxxopts::value<std::string>())(
+        "unsafe",
+        "Emit plain division, logarithms and exponentials instead of the "
+        "domain-safe forms")("h,help", "Print usage");
+
+    auto result = options.parse(argc, argv);
+    if (result.count("help")) {
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+
+    symcpp::GeneratorOptions generator_options;
+    generator_options.size = result["size"].as<size_t>();
+    generator_options.max_depth = result["depth"].as<size_t>();
+    generator_options.variables = result["variables"].as<size_t>();
+    generator_options.sharing = result["sharing"].as<double>();
+    generator_options.constants = result["constants"].as<double>();
+    generator_options.safe = result.count("unsafe") == 0;
+
+    try {
+        generator_options.shape =
+            symcpp::shape_from_name(result["shape"].as<std::string>());
+        if (result.count("weights")) {
+            std::string list = result["weights"].as<std::string>();
+            size_t start = 0;
+            while (start < list.size()) {
+                size_t end = list.find(',', start);
+                if (end == std::string::npos) {
+                    end = list.size();
+                }
+                std::string pair = list.substr(start, end - start);
+                size_t eq = pair.find('=');
+                if (eq == std::string::npos) {
+                    throw std::runtime_error("Invalid weight: " + pair);
+                }
+                std::string kind = pair.substr(0, eq);
+                bool found = false;
+                for (size_t k = 0; k < symcpp::node_kind_count; ++k) {
+                    auto node = static_cast<symcpp::NodeKind>(k);
+                    if (kind == symcpp::node_kind_name(node)) {
+                        generator_options.weights[k] =
+                            std::stod(pair.substr(eq + 1));
+                        found = true;
+                    }
+                }
+                if (!found) {
+                    throw std::runtime_error("Unknown node kind: " + kind);
+                }
+                start = end + 1;
+            }
+        }
+
+        symcpp::ExpressionGenerator<> generator(generator_options,
+                                                result["seed"].as<uint64_t>());
+        size_t count = result["count"].as<size_t>();
+        for (size_t i = 0; i < count; ++i) {
+            std::cout << generator.text() << '\n';
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}